@@ -9,6 +9,6 @@ public class PuzzlePlatformsTarget : TargetRules
 	{
 		Type = TargetType.Game;
 		DefaultBuildSettings = BuildSettingsVersion.V2;
-		ExtraModuleNames.Add("PuzzlePlatforms");
+		ExtraModuleNames.AddRange(new string[] { "PuzzlePlatforms", "PuzzlePlatformsMenu" });
 	}
 }
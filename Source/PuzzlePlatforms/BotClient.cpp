@@ -0,0 +1,85 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "BotClient.h"
+#include "Engine/GameInstance.h"
+#include "GameFramework/PlayerController.h"
+#include "PuzzlePlatformsCharacter.h"
+
+static const float BOT_JUMP_INTERVAL = 3.f;
+
+void UBotClient::BeginDestroy() {
+
+	if (TickerHandle.IsValid()) {
+
+		FTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+
+		TickerHandle.Reset();
+	}
+
+	Super::BeginDestroy();
+}
+
+void UBotClient::Start(EBotPattern InPattern, int32 InBotIndex) {
+
+	Pattern = InPattern;
+
+	BotIndex = InBotIndex;
+
+	Random.Initialize(BotIndex);
+
+	// Spread the bots out so they don't all move in lockstep.
+	Time = BotIndex * 0.37f;
+
+	if (!TickerHandle.IsValid()) {
+
+		TickerHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &UBotClient::Tick));
+	}
+
+	UE_LOG(LogTemp, Warning, TEXT("Bot %d driving pattern %s"), BotIndex, *UEnum::GetValueAsString(Pattern));
+}
+
+bool UBotClient::Tick(float DeltaTime) {
+
+	UGameInstance* GameInstance = Cast<UGameInstance>(GetOuter());
+
+	APlayerController* PlayerController = GameInstance != nullptr ? GameInstance->GetFirstLocalPlayerController() : nullptr;
+
+	APuzzlePlatformsCharacter* Character = PlayerController != nullptr ? Cast<APuzzlePlatformsCharacter>(PlayerController->GetPawn()) : nullptr;
+
+	if (Character == nullptr) return true;
+
+	Time += DeltaTime;
+
+	FVector2D Input = FVector2D::ZeroVector;
+
+	switch (Pattern) {
+
+	case EBotPattern::Circle:
+		Input = FVector2D(FMath::Cos(Time), FMath::Sin(Time));
+		break;
+
+	case EBotPattern::Zigzag:
+		Input = FVector2D(1.f, FMath::Sin(Time * 2.f) >= 0.f ? 1.f : -1.f);
+		break;
+
+	case EBotPattern::Wander:
+		if (Time >= NextWanderTime) {
+
+			WanderInput = FVector2D(Random.FRandRange(-1.f, 1.f), Random.FRandRange(-1.f, 1.f));
+
+			NextWanderTime = Time + Random.FRandRange(1.f, 3.f);
+		}
+		Input = WanderInput;
+		break;
+
+	default:
+		break;
+	}
+
+	const bool bJump = Pattern != EBotPattern::Idle && FMath::Fmod(Time, BOT_JUMP_INTERVAL) < DeltaTime;
+
+	Character->ApplyBotInput(Input.X, Input.Y, bJump);
+
+	return true;
+}
@@ -0,0 +1,58 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/NoExportTypes.h"
+#include "Containers/Ticker.h"
+#include "Math/RandomStream.h"
+#include "BotClient.generated.h"
+
+UENUM()
+enum class EBotPattern : uint8 {
+
+	Idle,
+
+	/** Runs in circles, jumping every few seconds. */
+	Circle,
+
+	/** Runs forward while switching strafe direction. */
+	Zigzag,
+
+	/** Picks a new random direction every couple of seconds. */
+	Wander
+};
+
+/**
+ * Drives the local APuzzlePlatformsCharacter of a headless bot client with a scripted input pattern.
+ * Enabled with -PuzzleBot=<Pattern> on the command line; see UPuzzlePlatformsGameInstance::SpawnBots.
+ */
+UCLASS()
+class PUZZLEPLATFORMS_API UBotClient : public UObject
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void BeginDestroy() override;
+
+	void Start(EBotPattern InPattern, int32 InBotIndex);
+
+private:
+
+	EBotPattern Pattern = EBotPattern::Idle;
+
+	int32 BotIndex = 0;
+
+	float Time = 0.f;
+
+	float NextWanderTime = 0.f;
+
+	FVector2D WanderInput = FVector2D::ZeroVector;
+
+	FRandomStream Random;
+
+	FDelegateHandle TickerHandle;
+
+	bool Tick(float DeltaTime);
+};
@@ -0,0 +1,272 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "LatencyProbe.h"
+#include "Sockets.h"
+#include "SocketSubsystem.h"
+#include "IPAddress.h"
+#include "Common/UdpSocketBuilder.h"
+#include "HAL/PlatformTime.h"
+
+static const uint32 LATENCY_PROBE_MAGIC = 0x50505042;
+
+struct FLatencyProbePacket {
+
+	uint32 Magic;
+
+	uint32 ProbeId;
+};
+
+FLatencyEchoServer::~FLatencyEchoServer() {
+
+	Stop();
+}
+
+int32 FLatencyEchoServer::Start(int32 FirstPort, int32 NumPortsToTry) {
+
+	if (Socket != nullptr) return Port;
+
+	for (int32 Candidate = FirstPort; Candidate < FirstPort + NumPortsToTry; Candidate++) {
+
+		Socket = FUdpSocketBuilder(TEXT("LatencyEchoServer")).AsNonBlocking().BoundToAddress(FIPv4Address::Any).BoundToPort(Candidate).Build();
+
+		if (Socket != nullptr) {
+
+			Port = Candidate;
+
+			TickerHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FLatencyEchoServer::Tick));
+
+			return Port;
+		}
+	}
+
+	UE_LOG(LogTemp, Warning, TEXT("Could not bind a latency probe port in [%d, %d)."), FirstPort, FirstPort + NumPortsToTry);
+
+	return 0;
+}
+
+void FLatencyEchoServer::Stop() {
+
+	if (TickerHandle.IsValid()) {
+
+		FTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+
+		TickerHandle.Reset();
+	}
+
+	if (Socket != nullptr) {
+
+		Socket->Close();
+
+		ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(Socket);
+
+		Socket = nullptr;
+	}
+
+	Port = 0;
+}
+
+bool FLatencyEchoServer::Tick(float DeltaTime) {
+
+	ISocketSubsystem* SocketSubsystem = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM);
+
+	TSharedRef<FInternetAddr> Sender = SocketSubsystem->CreateInternetAddr();
+
+	FLatencyProbePacket Packet;
+
+	int32 BytesRead = 0;
+
+	uint32 PendingSize = 0;
+
+	while (Socket->HasPendingData(PendingSize)) {
+
+		if (!Socket->RecvFrom(reinterpret_cast<uint8*>(&Packet), sizeof(Packet), BytesRead, *Sender)) break;
+
+		if (BytesRead != sizeof(Packet) || Packet.Magic != LATENCY_PROBE_MAGIC) continue;
+
+		int32 BytesSent = 0;
+
+		Socket->SendTo(reinterpret_cast<uint8*>(&Packet), sizeof(Packet), BytesSent, *Sender);
+	}
+
+	return true;
+}
+
+FLatencyProber::FLatencyProber(int32 InMaxOutstanding, int32 InProbesPerTarget, float InTimeoutSeconds)
+	: MaxOutstanding(FMath::Max(1, InMaxOutstanding))
+	, ProbesPerTarget(FMath::Max(1, InProbesPerTarget))
+	, TimeoutSeconds(InTimeoutSeconds) {
+
+	Socket = FUdpSocketBuilder(TEXT("LatencyProber")).AsNonBlocking().BoundToAddress(FIPv4Address::Any).BoundToPort(0).Build();
+
+	if (Socket == nullptr) {
+
+		UE_LOG(LogTemp, Warning, TEXT("Could not create the latency probe socket."));
+	}
+}
+
+FLatencyProber::~FLatencyProber() {
+
+	Reset();
+
+	if (Socket != nullptr) {
+
+		Socket->Close();
+
+		ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(Socket);
+
+		Socket = nullptr;
+	}
+}
+
+void FLatencyProber::AddTarget(const FString& TargetId, const FString& Ip, int32 Port) {
+
+	if (Socket == nullptr) return;
+
+	bool bIsValid = false;
+
+	TSharedRef<FInternetAddr> Address = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->CreateInternetAddr();
+
+	Address->SetIp(*Ip, bIsValid);
+
+	Address->SetPort(Port);
+
+	if (!bIsValid) return;
+
+	FTarget& Target = Targets.AddDefaulted_GetRef();
+
+	Target.Id = TargetId;
+
+	Target.Address = Address;
+
+	if (!TickerHandle.IsValid()) {
+
+		TickerHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FLatencyProber::Tick));
+	}
+}
+
+void FLatencyProber::Reset() {
+
+	if (TickerHandle.IsValid()) {
+
+		FTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+
+		TickerHandle.Reset();
+	}
+
+	Targets.Reset();
+
+	Outstanding.Reset();
+
+	NextTarget = 0;
+}
+
+bool FLatencyProber::Tick(float DeltaTime) {
+
+	const double Now = FPlatformTime::Seconds();
+
+	ReceiveProbes();
+
+	ExpireProbes(Now);
+
+	SendProbes(Now);
+
+	if (Outstanding.Num() == 0 && NextTarget >= Targets.Num()) {
+
+		// Everything answered or timed out; sleep until the next AddTarget.
+		Targets.Reset();
+
+		NextTarget = 0;
+
+		TickerHandle.Reset();
+
+		return false;
+	}
+
+	return true;
+}
+
+void FLatencyProber::ReceiveProbes() {
+
+	TSharedRef<FInternetAddr> Sender = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->CreateInternetAddr();
+
+	FLatencyProbePacket Packet;
+
+	int32 BytesRead = 0;
+
+	uint32 PendingSize = 0;
+
+	while (Socket->HasPendingData(PendingSize)) {
+
+		if (!Socket->RecvFrom(reinterpret_cast<uint8*>(&Packet), sizeof(Packet), BytesRead, *Sender)) break;
+
+		if (BytesRead != sizeof(Packet) || Packet.Magic != LATENCY_PROBE_MAGIC) continue;
+
+		FOutstandingProbe Probe;
+
+		if (!Outstanding.RemoveAndCopyValue(Packet.ProbeId, Probe)) continue;
+
+		Targets[Probe.TargetIndex].RoundTrips.Add(FPlatformTime::Seconds() - Probe.SendTime);
+
+		FinishProbe(Probe.TargetIndex);
+	}
+}
+
+void FLatencyProber::ExpireProbes(double Now) {
+
+	for (auto It = Outstanding.CreateIterator(); It; ++It) {
+
+		if (Now - It.Value().SendTime < TimeoutSeconds) continue;
+
+		const int32 TargetIndex = It.Value().TargetIndex;
+
+		It.RemoveCurrent();
+
+		FinishProbe(TargetIndex);
+	}
+}
+
+void FLatencyProber::SendProbes(double Now) {
+
+	// Probes go out in target order; the outstanding cap keeps bursts bounded however many sessions were found.
+	while (Outstanding.Num() < MaxOutstanding && NextTarget < Targets.Num()) {
+
+		FTarget& Target = Targets[NextTarget];
+
+		FLatencyProbePacket Packet = { LATENCY_PROBE_MAGIC, NextProbeId++ };
+
+		int32 BytesSent = 0;
+
+		if (Socket->SendTo(reinterpret_cast<uint8*>(&Packet), sizeof(Packet), BytesSent, *Target.Address)) {
+
+			Outstanding.Add(Packet.ProbeId, { NextTarget, Now });
+		}
+		else {
+
+			FinishProbe(NextTarget);
+		}
+
+		if (++Target.ProbesSent >= ProbesPerTarget) {
+
+			NextTarget++;
+		}
+	}
+}
+
+void FLatencyProber::FinishProbe(int32 TargetIndex) {
+
+	FTarget& Target = Targets[TargetIndex];
+
+	if (++Target.ProbesFinished < ProbesPerTarget) return;
+
+	int32 PingMs = INDEX_NONE;
+
+	if (Target.RoundTrips.Num() > 0) {
+
+		Target.RoundTrips.Sort();
+
+		PingMs = FMath::RoundToInt(Target.RoundTrips[Target.RoundTrips.Num() / 2] * 1000.f);
+	}
+
+	OnLatencyMeasured.ExecuteIfBound(Target.Id, PingMs);
+}
@@ -0,0 +1,109 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+
+class FSocket;
+class FInternetAddr;
+
+/**
+ * Answers latency probes on a UDP port advertised in the hosted session's settings.
+ */
+class PUZZLEPLATFORMS_API FLatencyEchoServer {
+
+public:
+
+	~FLatencyEchoServer();
+
+	/** Binds the first free port in [FirstPort, FirstPort + NumPortsToTry). Returns the bound port, or 0 on failure. */
+	int32 Start(int32 FirstPort, int32 NumPortsToTry);
+
+	void Stop();
+
+	int32 GetPort() const { return Port; }
+
+private:
+
+	FSocket* Socket = nullptr;
+
+	int32 Port = 0;
+
+	FDelegateHandle TickerHandle;
+
+	bool Tick(float DeltaTime);
+};
+
+/**
+ * Measures round-trip time to many hosts concurrently over one non-blocking UDP socket, polled from the core ticker.
+ * At most MaxOutstanding probes are in flight at once; each host reports the median of its answered probes.
+ */
+class PUZZLEPLATFORMS_API FLatencyProber {
+
+public:
+
+	DECLARE_DELEGATE_TwoParams(FOnLatencyMeasured, const FString& /* TargetId */, int32 /* PingMs, INDEX_NONE if every probe timed out */);
+
+	FLatencyProber(int32 InMaxOutstanding, int32 InProbesPerTarget, float InTimeoutSeconds);
+
+	~FLatencyProber();
+
+	void AddTarget(const FString& TargetId, const FString& Ip, int32 Port);
+
+	/** Drops every pending target and outstanding probe. */
+	void Reset();
+
+	FOnLatencyMeasured OnLatencyMeasured;
+
+private:
+
+	struct FTarget {
+
+		FString Id;
+
+		TSharedPtr<FInternetAddr> Address;
+
+		int32 ProbesSent = 0;
+
+		int32 ProbesFinished = 0;
+
+		TArray<float> RoundTrips;
+	};
+
+	struct FOutstandingProbe {
+
+		int32 TargetIndex;
+
+		double SendTime;
+	};
+
+	int32 MaxOutstanding;
+
+	int32 ProbesPerTarget;
+
+	float TimeoutSeconds;
+
+	FSocket* Socket = nullptr;
+
+	TArray<FTarget> Targets;
+
+	/** Next target that still has probes to send. */
+	int32 NextTarget = 0;
+
+	uint32 NextProbeId = 1;
+
+	TMap<uint32, FOutstandingProbe> Outstanding;
+
+	FDelegateHandle TickerHandle;
+
+	bool Tick(float DeltaTime);
+
+	void ReceiveProbes();
+
+	void ExpireProbes(double Now);
+
+	void SendProbes(double Now);
+
+	void FinishProbe(int32 TargetIndex);
+};
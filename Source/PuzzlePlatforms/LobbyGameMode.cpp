@@ -3,28 +3,191 @@
 
 #include "LobbyGameMode.h"
 #include "TimerManager.h"
+#include "GameFramework/GameStateBase.h"
+#include "GameFramework/PlayerState.h"
 #include "PuzzlePlatformsGameInstance.h"
+#include "LobbyPlayerController.h"
+#include "PuzzlePlatforms.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+DECLARE_CYCLE_STAT(TEXT("Lobby Preload Start"), STAT_LobbyPreloadStart, STATGROUP_PuzzlePlatforms);
+DECLARE_CYCLE_STAT(TEXT("Lobby Travel"), STAT_LobbyTravel, STATGROUP_PuzzlePlatforms);
+
+const static FString GAME_MAP = TEXT("/Game/PuzzlePlatforms/Maps/ThirdPersonExampleMap");
+
+ALobbyGameMode::ALobbyGameMode() {
+
+	PlayerControllerClass = ALobbyPlayerController::StaticClass();
+}
 
 void ALobbyGameMode::PostLogin(APlayerController* NewPlayer) {
 
 	Super::PostLogin(NewPlayer);
 
-	++NumberOfPlayers;
+	const bool bWasPreloading = bPreloading;
+
+	UpdateCountdown();
 
-	if (NumberOfPlayers >= 2) {
+	// Players joining mid-countdown start their own preload right away.
+	auto LobbyPlayerController = Cast<ALobbyPlayerController>(NewPlayer);
 
-		GetWorldTimerManager().SetTimer(GameStartTimer, this, &ALobbyGameMode::StartGame, 10, false);
+	if (bWasPreloading && LobbyPlayerController != nullptr) {
 
+		LobbyPlayerController->ClientPreloadMap(GAME_MAP);
 	}
 
 }
 
+int32 ALobbyGameMode::GetNumLobbyPlayers(const AController* Exiting) const {
+
+	if (GameState == nullptr) return 0;
+
+	int32 NumPlayers = GameState->PlayerArray.Num();
+
+	// The leaving player's state is only removed from the game state after Logout.
+	if (Exiting != nullptr && Exiting->PlayerState != nullptr && GameState->PlayerArray.Contains(Exiting->PlayerState)) {
+
+		NumPlayers--;
+	}
+
+	return NumPlayers;
+}
+
+void ALobbyGameMode::UpdateCountdown() {
+
+	if (bCountdownFinished) return;
+
+	const int32 NumPlayers = GetNumLobbyPlayers();
+
+	if (NumPlayers < MinPlayers) return;
+
+	const float Now = GetWorld()->GetTimeSeconds();
+
+	if (MinPlayersReachedTime < 0.f) {
+
+		MinPlayersReachedTime = Now;
+
+		BeginPreload();
+	}
+
+	auto GameInstance = Cast<UPuzzlePlatformsGameInstance>(GetGameInstance());
+
+	const bool bFull = bStartWhenFull && GameInstance != nullptr && NumPlayers >= GameInstance->GetSessionCapacity();
+
+	const float Delay = bFull ? 0.f : FMath::Min(LastJoinGrace, MinPlayersReachedTime + MaxWait - Now);
+
+	if (Delay <= 0.f) {
+
+		GetWorldTimerManager().ClearTimer(GameStartTimer);
+
+		OnCountdownFinished();
+
+		return;
+	}
+
+	GetWorldTimerManager().SetTimer(GameStartTimer, this, &ALobbyGameMode::OnCountdownFinished, Delay, false);
+}
+
+void ALobbyGameMode::BeginPreload() {
+
+	if (bPreloading) return;
+
+	SCOPE_CYCLE_COUNTER(STAT_LobbyPreloadStart);
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(ALobbyGameMode::BeginPreload);
+
+	auto GameInstance = Cast<UPuzzlePlatformsGameInstance>(GetGameInstance());
+
+	if (!ensure(GameInstance != nullptr)) return;
+
+	bPreloading = true;
+
+	PreloadStartTime = FPlatformTime::Seconds();
+
+	GameInstance->PreloadMap(GAME_MAP);
+
+	UWorld* World = GetWorld();
+
+	if (!ensure(World != nullptr)) return;
+
+	for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It) {
+
+		auto LobbyPlayerController = Cast<ALobbyPlayerController>(It->Get());
+
+		if (LobbyPlayerController != nullptr) {
+
+			LobbyPlayerController->ClientPreloadMap(GAME_MAP);
+		}
+	}
+}
+
+bool ALobbyGameMode::IsEveryonePreloaded(const AController* Ignored) const {
+
+	auto GameInstance = Cast<UPuzzlePlatformsGameInstance>(GetGameInstance());
+
+	if (GameInstance == nullptr || GameInstance->GetMapPreloadProgress() < 1.f) return false;
+
+	UWorld* World = GetWorld();
+
+	if (World == nullptr) return false;
+
+	for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It) {
+
+		auto LobbyPlayerController = Cast<ALobbyPlayerController>(It->Get());
+
+		if (LobbyPlayerController != nullptr && LobbyPlayerController != Ignored && LobbyPlayerController->GetPreloadProgress() < 1.f) return false;
+	}
+
+	return true;
+}
+
+void ALobbyGameMode::OnPreloadProgress(ALobbyPlayerController* PlayerController) {
+
+	if (PlayerController != nullptr && PlayerController->GetPreloadProgress() >= 1.f) {
+
+		UE_LOG(LogTemp, Warning, TEXT("%s preloaded the game map after %.2fs."), *PlayerController->GetName(), FPlatformTime::Seconds() - PreloadStartTime);
+	}
+
+	TryStartGame();
+}
+
+void ALobbyGameMode::OnCountdownFinished() {
+
+	bCountdownFinished = true;
+
+	UE_LOG(LogTemp, Warning, TEXT("Lobby countdown finished with %d players after %.1fs."), GetNumLobbyPlayers(), GetWorld()->GetTimeSeconds() - MinPlayersReachedTime);
+
+	GetWorldTimerManager().SetTimer(PreloadTimeoutTimer, this, &ALobbyGameMode::StartGame, FMath::Max(MaxPreloadWait, 0.01f), false);
+
+	TryStartGame();
+}
+
+void ALobbyGameMode::TryStartGame(const AController* Ignored) {
+
+	if (bCountdownFinished && IsEveryonePreloaded(Ignored)) {
+
+		StartGame();
+	}
+}
+
 void ALobbyGameMode::StartGame() {
 
+	if (bTravelling) return;
+
+	SCOPE_CYCLE_COUNTER(STAT_LobbyTravel);
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(ALobbyGameMode::StartGame);
+
 	auto GameInstance = Cast<UPuzzlePlatformsGameInstance>(GetGameInstance());
 
 	if (!ensure(GameInstance != nullptr)) return;
 
+	bTravelling = true;
+
+	GetWorldTimerManager().ClearTimer(PreloadTimeoutTimer);
+
+	UE_LOG(LogTemp, Warning, TEXT("Starting game %.2fs after the preload began (%s)."), FPlatformTime::Seconds() - PreloadStartTime, IsEveryonePreloaded() ? TEXT("everyone preloaded") : TEXT("preload timed out"));
+
 	GameInstance->StartSession();
 
 	UWorld* World = GetWorld();
@@ -33,7 +196,9 @@ void ALobbyGameMode::StartGame() {
 
 	bUseSeamlessTravel = true;
 
-	World->ServerTravel("/Game/PuzzlePlatforms/Maps/ThirdPersonExampleMap");
+	GameInstance->BeginMapTravel();
+
+	World->ServerTravel(GAME_MAP);
 
 }
 
@@ -41,6 +206,14 @@ void ALobbyGameMode::Logout(AController* Exiting) {
 
 	Super::Logout(Exiting);
 
-	--NumberOfPlayers;
+	if (!bCountdownFinished && GetNumLobbyPlayers(Exiting) < MinPlayers) {
+
+		GetWorldTimerManager().ClearTimer(GameStartTimer);
+
+		MinPlayersReachedTime = -1.f;
+	}
+
+	// A player leaving may have been the last one still loading.
+	TryStartGame(Exiting);
 
-}
\ No newline at end of file
+}
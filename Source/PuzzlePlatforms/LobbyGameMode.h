@@ -7,24 +7,73 @@
 #include "LobbyGameMode.generated.h"
 
 /**
- * 
+ * Starts the match once enough players are in: right away when the session is full, otherwise after a short
+ * grace period without new joins, and never later than MaxWait after the lobby first had MinPlayers.
  */
-UCLASS()
+UCLASS(Config = Game)
 class PUZZLEPLATFORMS_API ALobbyGameMode : public APuzzlePlatformsGameMode
 {
 	GENERATED_BODY()
 
 public:
 
+	ALobbyGameMode();
+
 	virtual void PostLogin(APlayerController* NewPlayer) override;
 
 	virtual void Logout(AController* Exiting) override;
 
+	/** Called by a lobby player controller whenever its client reports preload progress. */
+	void OnPreloadProgress(class ALobbyPlayerController* PlayerController);
+
 private:
 
+	UPROPERTY(Config)
+	int32 MinPlayers = 2;
+
+	/** Longest countdown in seconds, measured from when the lobby first had MinPlayers. */
+	UPROPERTY(Config)
+	float MaxWait = 20.f;
+
+	/** Seconds without a new join before the countdown ends. */
+	UPROPERTY(Config)
+	float LastJoinGrace = 5.f;
+
+	UPROPERTY(Config)
+	bool bStartWhenFull = true;
+
+	/** How long to wait after the countdown for slow clients to finish preloading before travelling anyway. */
+	UPROPERTY(Config)
+	float MaxPreloadWait = 10.f;
+
 	void StartGame();
 
-	uint32 NumberOfPlayers = 0;
+	/** Players in the lobby according to the game state, not counting Exiting. */
+	int32 GetNumLobbyPlayers(const AController* Exiting = nullptr) const;
+
+	void UpdateCountdown();
+
+	/** Countdown is over; travel once the server and every client have the map in memory. */
+	void OnCountdownFinished();
+
+	void BeginPreload();
+
+	void TryStartGame(const AController* Ignored = nullptr);
+
+	bool IsEveryonePreloaded(const AController* Ignored = nullptr) const;
+
+	/** World time the lobby first had MinPlayers, or a negative value while it has fewer. */
+	float MinPlayersReachedTime = -1.f;
 
 	FTimerHandle GameStartTimer;
+
+	FTimerHandle PreloadTimeoutTimer;
+
+	bool bPreloading = false;
+
+	bool bCountdownFinished = false;
+
+	bool bTravelling = false;
+
+	double PreloadStartTime = 0.0;
 };
@@ -0,0 +1,84 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "LobbyPlayerController.h"
+#include "TimerManager.h"
+#include "LobbyGameMode.h"
+#include "PuzzlePlatformsGameInstance.h"
+
+const static float PRELOAD_REPORT_INTERVAL = 0.25f;
+
+void ALobbyPlayerController::ClientPreloadMap_Implementation(const FString& MapPackageName) {
+
+	auto GameInstance = Cast<UPuzzlePlatformsGameInstance>(GetGameInstance());
+
+	if (!ensure(GameInstance != nullptr)) return;
+
+	GameInstance->PreloadMap(MapPackageName);
+
+	LastReportedProgress = -1.f;
+
+	GetWorldTimerManager().SetTimer(PreloadReportTimer, this, &ALobbyPlayerController::ReportPreloadProgress, PRELOAD_REPORT_INTERVAL, true, 0.f);
+}
+
+void ALobbyPlayerController::ReportPreloadProgress() {
+
+	auto GameInstance = Cast<UPuzzlePlatformsGameInstance>(GetGameInstance());
+
+	if (!ensure(GameInstance != nullptr)) return;
+
+	const float Progress = GameInstance->GetMapPreloadProgress();
+
+	// Only send changes, the RPC is reliable.
+	if (Progress != LastReportedProgress) {
+
+		LastReportedProgress = Progress;
+
+		ServerReportPreloadProgress(Progress);
+	}
+
+	if (Progress >= 1.f) {
+
+		GetWorldTimerManager().ClearTimer(PreloadReportTimer);
+	}
+}
+
+bool ALobbyPlayerController::ServerReportPreloadProgress_Validate(float Progress) {
+
+	return Progress >= 0.f && Progress <= 1.f;
+}
+
+void ALobbyPlayerController::ServerReportPreloadProgress_Implementation(float Progress) {
+
+	PreloadProgress = Progress;
+
+	UWorld* World = GetWorld();
+
+	if (World == nullptr) return;
+
+	auto GameMode = World->GetAuthGameMode<ALobbyGameMode>();
+
+	if (GameMode != nullptr) {
+
+		GameMode->OnPreloadProgress(this);
+	}
+}
+
+void ALobbyPlayerController::PreClientTravel(const FString& PendingURL, ETravelType TravelType, bool bIsSeamlessTravel) {
+
+	Super::PreClientTravel(PendingURL, TravelType, bIsSeamlessTravel);
+
+	auto GameInstance = Cast<UPuzzlePlatformsGameInstance>(GetGameInstance());
+
+	if (GameInstance != nullptr) {
+
+		GameInstance->BeginMapTravel();
+	}
+}
+
+void ALobbyPlayerController::EndPlay(const EEndPlayReason::Type EndPlayReason) {
+
+	Super::EndPlay(EndPlayReason);
+
+	GetWorldTimerManager().ClearTimer(PreloadReportTimer);
+}
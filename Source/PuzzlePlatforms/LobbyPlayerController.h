@@ -0,0 +1,43 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/PlayerController.h"
+#include "LobbyPlayerController.generated.h"
+
+/**
+ * Preloads the gameplay map on its owning client during the lobby countdown and reports the progress to the server.
+ */
+UCLASS()
+class PUZZLEPLATFORMS_API ALobbyPlayerController : public APlayerController
+{
+	GENERATED_BODY()
+
+public:
+
+	UFUNCTION(Client, Reliable)
+	void ClientPreloadMap(const FString& MapPackageName);
+
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerReportPreloadProgress(float Progress);
+
+	/** Last progress the owning client reported, from 0 to 1. Only valid on the server. */
+	float GetPreloadProgress() const { return PreloadProgress; }
+
+	virtual void PreClientTravel(const FString& PendingURL, ETravelType TravelType, bool bIsSeamlessTravel) override;
+
+protected:
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+
+	float PreloadProgress = 0.f;
+
+	float LastReportedProgress = -1.f;
+
+	FTimerHandle PreloadReportTimer;
+
+	void ReportPreloadProgress();
+};
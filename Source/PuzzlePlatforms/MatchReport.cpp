@@ -0,0 +1,465 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MatchReport.h"
+#include "Engine/World.h"
+#include "Engine/NetDriver.h"
+#include "Engine/NetConnection.h"
+#include "GameFramework/GameStateBase.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerState.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonWriter.h"
+#include "Serialization/JsonSerializer.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "MovingPlatformSubsystem.h"
+#include "PuzzlePlatformsCharacterMovement.h"
+
+const static float CONNECTION_SAMPLE_INTERVAL = 1.f;
+
+/** Layout of histograms written before the layout was part of the JSON. */
+const static float LEGACY_HISTOGRAM_BIN_MS = 0.25f;
+const static int32 LEGACY_HISTOGRAM_NUM_BINS = 400;
+
+FTimingHistogram::FTimingHistogram(float InBinWidthMs, int32 InNumBins)
+	: BinWidthMs(InBinWidthMs)
+	, NumBins(InNumBins) {
+
+	Bins.SetNumZeroed(NumBins + 1);
+}
+
+float FTimingHistogram::Percentile(float Percent) const {
+
+	if (NumSamples == 0) return 0.f;
+
+	const uint64 Target = FMath::Max<uint64>(1, FMath::CeilToInt(double(NumSamples) * Percent / 100.0));
+
+	uint64 Count = 0;
+
+	for (int32 Bin = 0; Bin < NumBins; Bin++) {
+
+		Count += Bins[Bin];
+
+		if (Count >= Target) {
+
+			return FMath::Min((Bin + 1) * BinWidthMs, MaxMs);
+		}
+	}
+
+	return MaxMs;
+}
+
+void FTimingHistogram::Merge(const FTimingHistogram& Other) {
+
+	if (Other.BinWidthMs == BinWidthMs && Other.NumBins == NumBins) {
+
+		for (int32 Bin = 0; Bin <= NumBins; Bin++) {
+
+			Bins[Bin] += Other.Bins[Bin];
+		}
+	}
+	else {
+
+		for (int32 Bin = 0; Bin <= Other.NumBins; Bin++) {
+
+			const float Ms = Bin < Other.NumBins ? (Bin + 0.5f) * Other.BinWidthMs : Other.MaxMs;
+
+			Bins[GetBin(Ms)] += Other.Bins[Bin];
+		}
+	}
+
+	NumSamples += Other.NumSamples;
+
+	MaxMs = FMath::Max(MaxMs, Other.MaxMs);
+}
+
+TSharedRef<FJsonObject> FTimingHistogram::ToJson() const {
+
+	TSharedRef<FJsonObject> Json = MakeShared<FJsonObject>();
+
+	Json->SetNumberField(TEXT("binMs"), BinWidthMs);
+	Json->SetNumberField(TEXT("numBins"), NumBins);
+	Json->SetNumberField(TEXT("n"), NumSamples);
+	Json->SetNumberField(TEXT("max"), MaxMs);
+	Json->SetNumberField(TEXT("p50"), Percentile(50.f));
+	Json->SetNumberField(TEXT("p90"), Percentile(90.f));
+	Json->SetNumberField(TEXT("p99"), Percentile(99.f));
+
+	TArray<TSharedPtr<FJsonValue>> JsonBins;
+
+	for (int32 Bin = 0; Bin <= NumBins; Bin++) {
+
+		if (Bins[Bin] == 0) continue;
+
+		TArray<TSharedPtr<FJsonValue>> Pair;
+		Pair.Add(MakeShared<FJsonValueNumber>(Bin));
+		Pair.Add(MakeShared<FJsonValueNumber>(Bins[Bin]));
+
+		JsonBins.Add(MakeShared<FJsonValueArray>(Pair));
+	}
+
+	Json->SetArrayField(TEXT("bins"), JsonBins);
+
+	return Json;
+}
+
+bool FTimingHistogram::FromJson(const TSharedPtr<FJsonObject>& Json) {
+
+	if (!Json.IsValid()) return false;
+
+	double JsonBinWidthMs = LEGACY_HISTOGRAM_BIN_MS;
+
+	int32 JsonNumBins = LEGACY_HISTOGRAM_NUM_BINS;
+
+	Json->TryGetNumberField(TEXT("binMs"), JsonBinWidthMs);
+
+	Json->TryGetNumberField(TEXT("numBins"), JsonNumBins);
+
+	if (JsonBinWidthMs <= 0.0 || JsonNumBins <= 0) return false;
+
+	*this = FTimingHistogram(float(JsonBinWidthMs), JsonNumBins);
+
+	const TArray<TSharedPtr<FJsonValue>>* JsonBins = nullptr;
+
+	if (!Json->TryGetArrayField(TEXT("bins"), JsonBins)) return false;
+
+	for (const TSharedPtr<FJsonValue>& JsonBin : *JsonBins) {
+
+		const TArray<TSharedPtr<FJsonValue>>& Pair = JsonBin->AsArray();
+
+		if (Pair.Num() != 2) return false;
+
+		const int32 Bin = int32(Pair[0]->AsNumber());
+
+		if (Bin < 0 || Bin > NumBins) return false;
+
+		Bins[Bin] += uint32(Pair[1]->AsNumber());
+	}
+
+	NumSamples = uint32(Json->GetNumberField(TEXT("n")));
+
+	MaxMs = float(Json->GetNumberField(TEXT("max")));
+
+	return true;
+}
+
+void FMatchReport::Merge(const FMatchReport& Other) {
+
+	NumMatches += Other.NumMatches;
+
+	DurationSeconds += Other.DurationSeconds;
+
+	FrameTimes.Merge(Other.FrameTimes);
+
+	GameThreadTimes.Merge(Other.GameThreadTimes);
+
+	JoinLatencies.Merge(Other.JoinLatencies);
+
+	NumFrames += Other.NumFrames;
+
+	MovingPlatformFrames += Other.MovingPlatformFrames;
+
+	MaxMovingPlatforms = FMath::Max(MaxMovingPlatforms, Other.MaxMovingPlatforms);
+
+	MaxPlayers = FMath::Max(MaxPlayers, Other.MaxPlayers);
+
+	TotalJoins += Other.TotalJoins;
+
+	Corrections += Other.Corrections;
+
+	PlatformCorrections += Other.PlatformCorrections;
+
+	Connections.Append(Other.Connections);
+}
+
+FString FMatchReport::ToJsonString() const {
+
+	TSharedRef<FJsonObject> Json = MakeShared<FJsonObject>();
+
+	Json->SetStringField(TEXT("map"), MapName);
+	Json->SetStringField(TEXT("start"), StartTime);
+	Json->SetNumberField(TEXT("matches"), NumMatches);
+	Json->SetNumberField(TEXT("duration"), DurationSeconds);
+	Json->SetObjectField(TEXT("frameMs"), FrameTimes.ToJson());
+	Json->SetObjectField(TEXT("gameThreadMs"), GameThreadTimes.ToJson());
+	Json->SetObjectField(TEXT("joinMs"), JoinLatencies.ToJson());
+	Json->SetNumberField(TEXT("frames"), NumFrames);
+	Json->SetNumberField(TEXT("movingPlatformFrames"), MovingPlatformFrames);
+	Json->SetNumberField(TEXT("avgMovingPlatforms"), GetAverageMovingPlatforms());
+	Json->SetNumberField(TEXT("maxMovingPlatforms"), MaxMovingPlatforms);
+	Json->SetNumberField(TEXT("maxPlayers"), MaxPlayers);
+	Json->SetNumberField(TEXT("joins"), TotalJoins);
+	Json->SetNumberField(TEXT("corrections"), Corrections);
+	Json->SetNumberField(TEXT("platformCorrections"), PlatformCorrections);
+	Json->SetNumberField(TEXT("correctionsPerMinute"), GetCorrectionsPerMinute());
+	Json->SetNumberField(TEXT("platformCorrectionsPerMinute"), GetPlatformCorrectionsPerMinute());
+
+	TArray<TSharedPtr<FJsonValue>> JsonConnections;
+
+	for (const FConnectionReport& Connection : Connections) {
+
+		TSharedRef<FJsonObject> JsonConnection = MakeShared<FJsonObject>();
+
+		JsonConnection->SetStringField(TEXT("name"), Connection.Name);
+		JsonConnection->SetNumberField(TEXT("seconds"), Connection.ConnectedSeconds);
+		JsonConnection->SetNumberField(TEXT("outBytes"), Connection.OutBytes);
+		JsonConnection->SetNumberField(TEXT("avgOutBps"), Connection.ConnectedSeconds > 0.0 ? Connection.OutBytes / Connection.ConnectedSeconds : 0.0);
+		JsonConnection->SetNumberField(TEXT("peakOutBps"), Connection.PeakOutBytesPerSecond);
+
+		JsonConnections.Add(MakeShared<FJsonValueObject>(JsonConnection));
+	}
+
+	Json->SetArrayField(TEXT("connections"), JsonConnections);
+
+	FString JsonString;
+
+	TSharedRef<TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>> Writer = TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&JsonString);
+
+	FJsonSerializer::Serialize(Json, Writer);
+
+	return JsonString;
+}
+
+bool FMatchReport::FromJsonString(const FString& JsonString) {
+
+	*this = FMatchReport();
+
+	TSharedPtr<FJsonObject> Json;
+
+	if (!FJsonSerializer::Deserialize(TJsonReaderFactory<TCHAR>::Create(JsonString), Json) || !Json.IsValid()) return false;
+
+	MapName = Json->GetStringField(TEXT("map"));
+	StartTime = Json->GetStringField(TEXT("start"));
+	NumMatches = int32(Json->GetNumberField(TEXT("matches")));
+	DurationSeconds = Json->GetNumberField(TEXT("duration"));
+	NumFrames = uint64(Json->GetNumberField(TEXT("frames")));
+	MovingPlatformFrames = uint64(Json->GetNumberField(TEXT("movingPlatformFrames")));
+	MaxMovingPlatforms = int32(Json->GetNumberField(TEXT("maxMovingPlatforms")));
+	MaxPlayers = int32(Json->GetNumberField(TEXT("maxPlayers")));
+	TotalJoins = int32(Json->GetNumberField(TEXT("joins")));
+
+	double JsonCorrections = 0.0;
+
+	double JsonPlatformCorrections = 0.0;
+
+	// Reports written before corrections were recorded have neither field.
+	Json->TryGetNumberField(TEXT("corrections"), JsonCorrections);
+	Json->TryGetNumberField(TEXT("platformCorrections"), JsonPlatformCorrections);
+
+	Corrections = int32(JsonCorrections);
+	PlatformCorrections = int32(JsonPlatformCorrections);
+
+	if (!FrameTimes.FromJson(Json->GetObjectField(TEXT("frameMs")))) return false;
+
+	if (!GameThreadTimes.FromJson(Json->GetObjectField(TEXT("gameThreadMs")))) return false;
+
+	if (!JoinLatencies.FromJson(Json->GetObjectField(TEXT("joinMs")))) return false;
+
+	const TArray<TSharedPtr<FJsonValue>>* JsonConnections = nullptr;
+
+	if (Json->TryGetArrayField(TEXT("connections"), JsonConnections)) {
+
+		for (const TSharedPtr<FJsonValue>& JsonValue : *JsonConnections) {
+
+			const TSharedPtr<FJsonObject>& JsonConnection = JsonValue->AsObject();
+
+			if (!JsonConnection.IsValid()) continue;
+
+			FConnectionReport& Connection = Connections.AddDefaulted_GetRef();
+
+			Connection.Name = JsonConnection->GetStringField(TEXT("name"));
+			Connection.ConnectedSeconds = JsonConnection->GetNumberField(TEXT("seconds"));
+			Connection.OutBytes = uint64(JsonConnection->GetNumberField(TEXT("outBytes")));
+			Connection.PeakOutBytesPerSecond = uint32(JsonConnection->GetNumberField(TEXT("peakOutBps")));
+		}
+	}
+
+	return true;
+}
+
+FMatchRecorder::~FMatchRecorder() {
+
+	if (TickerHandle.IsValid()) {
+
+		FTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+	}
+}
+
+void FMatchRecorder::Start(UWorld* InWorld) {
+
+	if (!ensure(InWorld != nullptr)) return;
+
+	World = InWorld;
+
+	Report = FMatchReport();
+
+	Report.MapName = UWorld::RemovePIEPrefix(InWorld->GetMapName());
+
+	Report.StartTime = FDateTime::UtcNow().ToIso8601();
+
+	StartTime = FPlatformTime::Seconds();
+
+	ConnectionSampleTimer = 0.f;
+
+	StartCorrections = UPuzzlePlatformsCharacterMovement::GetTotalCorrectionsSent();
+
+	StartPlatformCorrections = UPuzzlePlatformsCharacterMovement::GetTotalPlatformCorrectionsSent();
+
+	ConnectionIndices.Reset();
+
+	LastOutTotalBytes.Reset();
+
+	UNetDriver* NetDriver = InWorld->GetNetDriver();
+
+	if (NetDriver != nullptr) {
+
+		for (UNetConnection* Connection : NetDriver->ClientConnections) {
+
+			if (Connection != nullptr) {
+
+				LastOutTotalBytes.Add(Connection, uint32(Connection->OutTotalBytes));
+			}
+		}
+	}
+
+	if (!TickerHandle.IsValid()) {
+
+		TickerHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FMatchRecorder::Tick));
+	}
+}
+
+void FMatchRecorder::OnLoginRequest(const FString& Address) {
+
+	PendingLogins.FindOrAdd(Address).Add(FPlatformTime::Seconds());
+}
+
+void FMatchRecorder::OnPlayerJoined(APlayerController* PlayerController) {
+
+	Report.TotalJoins++;
+
+	UNetConnection* Connection = PlayerController != nullptr ? PlayerController->GetNetConnection() : nullptr;
+
+	if (Connection == nullptr) return;
+
+	// PreLogin is given the address without the port.
+	TArray<double>* LoginTimes = PendingLogins.Find(Connection->LowLevelGetRemoteAddress());
+
+	if (LoginTimes == nullptr || LoginTimes->Num() == 0) return;
+
+	Report.JoinLatencies.Add((FPlatformTime::Seconds() - (*LoginTimes)[0]) * 1000.0);
+
+	LoginTimes->RemoveAt(0, 1, false);
+}
+
+bool FMatchRecorder::Tick(float DeltaTime) {
+
+	UWorld* RecordWorld = World.Get();
+
+	if (RecordWorld == nullptr) return true;
+
+	Report.FrameTimes.Add(DeltaTime * 1000.f);
+
+	Report.GameThreadTimes.Add(FPlatformTime::ToMilliseconds(GGameThreadTime));
+
+	Report.NumFrames++;
+
+	UMovingPlatformSubsystem* PlatformSubsystem = RecordWorld->GetSubsystem<UMovingPlatformSubsystem>();
+
+	const int32 MovingPlatforms = PlatformSubsystem != nullptr ? PlatformSubsystem->GetNumMovingPlatforms() : 0;
+
+	Report.MovingPlatformFrames += MovingPlatforms;
+
+	Report.MaxMovingPlatforms = FMath::Max(Report.MaxMovingPlatforms, MovingPlatforms);
+
+	ConnectionSampleTimer += DeltaTime;
+
+	if (ConnectionSampleTimer >= CONNECTION_SAMPLE_INTERVAL) {
+
+		SampleConnections(ConnectionSampleTimer);
+
+		ConnectionSampleTimer = 0.f;
+	}
+
+	return true;
+}
+
+void FMatchRecorder::SampleConnections(float SampleSeconds) {
+
+	UWorld* RecordWorld = World.Get();
+
+	AGameStateBase* GameState = RecordWorld != nullptr ? RecordWorld->GetGameState() : nullptr;
+
+	if (GameState != nullptr) {
+
+		Report.MaxPlayers = FMath::Max(Report.MaxPlayers, GameState->PlayerArray.Num());
+	}
+
+	UNetDriver* NetDriver = RecordWorld != nullptr ? RecordWorld->GetNetDriver() : nullptr;
+
+	if (NetDriver == nullptr) return;
+
+	for (UNetConnection* Connection : NetDriver->ClientConnections) {
+
+		if (Connection == nullptr) continue;
+
+		int32* Index = ConnectionIndices.Find(Connection);
+
+		if (Index == nullptr) {
+
+			APlayerController* PlayerController = Connection->PlayerController;
+
+			FConnectionReport& ConnectionReport = Report.Connections.AddDefaulted_GetRef();
+
+			ConnectionReport.Name = PlayerController != nullptr && PlayerController->PlayerState != nullptr ? PlayerController->PlayerState->GetPlayerName() : Connection->LowLevelGetRemoteAddress(true);
+
+			Index = &ConnectionIndices.Add(Connection, Report.Connections.Num() - 1);
+		}
+
+		FConnectionReport& ConnectionReport = Report.Connections[*Index];
+
+		ConnectionReport.ConnectedSeconds += SampleSeconds;
+
+		// Unsigned, so the difference stays right when the int32 counter wraps.
+		const uint32 OutTotalBytes = uint32(Connection->OutTotalBytes);
+
+		ConnectionReport.OutBytes += OutTotalBytes - LastOutTotalBytes.FindRef(Connection);
+
+		LastOutTotalBytes.Add(Connection, OutTotalBytes);
+
+		ConnectionReport.PeakOutBytesPerSecond = FMath::Max<uint32>(ConnectionReport.PeakOutBytesPerSecond, Connection->OutBytesPerSecond);
+	}
+}
+
+FString FMatchRecorder::Finish() {
+
+	if (!TickerHandle.IsValid()) return FString();
+
+	FTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+
+	TickerHandle.Reset();
+
+	SampleConnections(ConnectionSampleTimer);
+
+	Report.DurationSeconds = FPlatformTime::Seconds() - StartTime;
+
+	Report.Corrections = UPuzzlePlatformsCharacterMovement::GetTotalCorrectionsSent() - StartCorrections;
+
+	Report.PlatformCorrections = UPuzzlePlatformsCharacterMovement::GetTotalPlatformCorrectionsSent() - StartPlatformCorrections;
+
+	if (Report.NumFrames == 0) return FString();
+
+	const FString Path = FPaths::ProjectSavedDir() / TEXT("MatchReports") / FString::Printf(TEXT("Match_%s_%s.json"), *Report.MapName, *FDateTime::Now().ToString());
+
+	if (!FFileHelper::SaveStringToFile(Report.ToJsonString(), *Path)) {
+
+		UE_LOG(LogTemp, Warning, TEXT("Could not write match report %s."), *Path);
+
+		return FString();
+	}
+
+	UE_LOG(LogTemp, Warning, TEXT("Match report: %.0fs, frame p50/p99 %.2f/%.2fms, %d joins, %.1f corrections/min (%.1f on platforms), wrote %s."), Report.DurationSeconds, Report.FrameTimes.Percentile(50.f), Report.FrameTimes.Percentile(99.f), Report.TotalJoins, Report.GetCorrectionsPerMinute(), Report.GetPlatformCorrectionsPerMinute(), *Path);
+
+	return Path;
+}
@@ -0,0 +1,168 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+
+class FJsonObject;
+
+/**
+ * Fixed-bin histogram of millisecond timings. Adding a sample is a single increment, so it can run every frame,
+ * and histograms with the same bin layout merge exactly. The layout is written with the bins, so reports read back
+ * keep the layout they were recorded with.
+ */
+struct PUZZLEPLATFORMS_API FTimingHistogram {
+
+	explicit FTimingHistogram(float InBinWidthMs = 0.25f, int32 InNumBins = 400);
+
+	float BinWidthMs;
+
+	int32 NumBins;
+
+	/** NumBins bins of BinWidthMs, plus one overflow bin for everything at or above NumBins * BinWidthMs. */
+	TArray<uint32> Bins;
+
+	uint32 NumSamples = 0;
+
+	float MaxMs = 0.f;
+
+	void Add(float Ms) {
+
+		Bins[GetBin(Ms)]++;
+
+		NumSamples++;
+
+		MaxMs = FMath::Max(MaxMs, Ms);
+	}
+
+	int32 GetBin(float Ms) const {
+
+		const int32 Bin = FMath::FloorToInt(Ms / BinWidthMs);
+
+		return Bin < 0 ? 0 : (Bin > NumBins ? NumBins : Bin);
+	}
+
+	/** Upper edge of the bin holding the given percentile (0-100); MaxMs for the overflow bin. */
+	float Percentile(float Percent) const;
+
+	/** Exact for the same bin layout; otherwise each of Other's bins is counted at its midpoint. */
+	void Merge(const FTimingHistogram& Other);
+
+	/** Only non-empty bins are written, as [bin, count] pairs, after the bin layout. */
+	TSharedRef<FJsonObject> ToJson() const;
+
+	bool FromJson(const TSharedPtr<FJsonObject>& Json);
+};
+
+/** Replication totals for one client connection over a match. */
+struct PUZZLEPLATFORMS_API FConnectionReport {
+
+	FString Name;
+
+	double ConnectedSeconds = 0.0;
+
+	uint64 OutBytes = 0;
+
+	uint32 PeakOutBytesPerSecond = 0;
+};
+
+/**
+ * Aggregates of one match (or, once merged, of many): frame and game thread time distributions, replicated bytes
+ * per connection, active moving platforms, movement corrections, join latencies and player counts.
+ */
+struct PUZZLEPLATFORMS_API FMatchReport {
+
+	FString MapName;
+
+	FString StartTime;
+
+	int32 NumMatches = 1;
+
+	double DurationSeconds = 0.0;
+
+	FTimingHistogram FrameTimes;
+
+	FTimingHistogram GameThreadTimes;
+
+	/** Time from a player's login request to PostLogin. Includes the client's map load, so the bins are much wider. */
+	FTimingHistogram JoinLatencies { 20.f, 3000 };
+
+	uint64 NumFrames = 0;
+
+	uint64 MovingPlatformFrames = 0;
+
+	int32 MaxMovingPlatforms = 0;
+
+	int32 MaxPlayers = 0;
+
+	int32 TotalJoins = 0;
+
+	/** Position corrections sent to clients, and how many of those were sent to characters on a moving platform. */
+	int32 Corrections = 0;
+
+	int32 PlatformCorrections = 0;
+
+	TArray<FConnectionReport> Connections;
+
+	double GetAverageMovingPlatforms() const { return NumFrames > 0 ? double(MovingPlatformFrames) / NumFrames : 0.0; }
+
+	double GetCorrectionsPerMinute() const { return DurationSeconds > 0.0 ? Corrections * 60.0 / DurationSeconds : 0.0; }
+
+	double GetPlatformCorrectionsPerMinute() const { return DurationSeconds > 0.0 ? PlatformCorrections * 60.0 / DurationSeconds : 0.0; }
+
+	/** Adds another report's aggregates to this one. Connections are kept per match, so only their totals are merged. */
+	void Merge(const FMatchReport& Other);
+
+	FString ToJsonString() const;
+
+	bool FromJsonString(const FString& JsonString);
+};
+
+/**
+ * Collects an FMatchReport for a server world from the core ticker. Everything runs on the game thread, so
+ * there are no locks; per-frame work is a few increments, connections are sampled once per second.
+ */
+class PUZZLEPLATFORMS_API FMatchRecorder {
+
+public:
+
+	~FMatchRecorder();
+
+	void Start(UWorld* InWorld);
+
+	void OnLoginRequest(const FString& Address);
+
+	void OnPlayerJoined(class APlayerController* PlayerController);
+
+	/** Stops recording and writes the report to Saved/MatchReports. Returns the file written, or an empty string. */
+	FString Finish();
+
+private:
+
+	TWeakObjectPtr<UWorld> World;
+
+	FMatchReport Report;
+
+	double StartTime = 0.0;
+
+	float ConnectionSampleTimer = 0.f;
+
+	int32 StartCorrections = 0;
+
+	int32 StartPlatformCorrections = 0;
+
+	/** Login request times by remote address, oldest first; several bots can share one address. */
+	TMap<FString, TArray<double>> PendingLogins;
+
+	TMap<TWeakObjectPtr<class UNetConnection>, int32> ConnectionIndices;
+
+	/** Each connection's OutTotalBytes at the last sample; connections carried over from the previous map start from their value at Start. */
+	TMap<TWeakObjectPtr<class UNetConnection>, uint32> LastOutTotalBytes;
+
+	FDelegateHandle TickerHandle;
+
+	bool Tick(float DeltaTime);
+
+	void SampleConnections(float SampleSeconds);
+};
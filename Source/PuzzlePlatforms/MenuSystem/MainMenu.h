@@ -1,106 +0,0 @@
-// Fill out your copyright notice in the Description page of Project Settings.
-
-#pragma once
-
-#include "CoreMinimal.h"
-#include "MenuWidget.h"
-#include "MainMenu.generated.h"
-
-USTRUCT()
-struct  FServerData {
-
-	GENERATED_BODY()
-
-	FString Name;
-
-	uint16 CurrentPlayers;
-
-	uint16 TotalPlayers;
-
-	FString HostUserName;
-
-};
-
-/**
- * 
- */
-UCLASS()
-class PUZZLEPLATFORMS_API UMainMenu : public UMenuWidget {	
-	
-	GENERATED_BODY()	
-
-public:
-
-	UMainMenu(const FObjectInitializer& ObjectInitializer);
-
-	void SetServerList(TArray<FServerData> ServerNames);
-
-	void SelectIndex(uint32 Index);
-
-protected:
-
-	virtual bool Initialize() override;
-
-private:
-
-	UPROPERTY(meta = (BindWidget))
-	class UButton* HostButton;
-
-	UPROPERTY(meta = (BindWidget))
-	class UButton* JoinButton;
-
-	UPROPERTY(meta = (BindWidget))
-	class UButton* QuitButton;
-
-	UPROPERTY(meta = (BindWidget))
-	class UButton* JoinIPButton;
-
-	UPROPERTY(meta = (BindWidget))
-	class UButton* CancelJoinButton;
-
-	UPROPERTY(meta = (BindWidget))
-	class UWidgetSwitcher* MenuSwitcher;
-
-	UPROPERTY(meta = (BindWidget))
-	class UWidget* JoinMenu;
-
-	UPROPERTY(meta = (BindWidget))
-	class UWidget* HostMenu;
-
-	UPROPERTY(meta = (BindWidget))
-	class UEditableTextBox* ServerHostName;
-
-	UPROPERTY(meta = (BindWidget))
-	class UButton* CancelHostButton;
-
-	UPROPERTY(meta = (BindWidget))
-	class UButton* HostGameButton;
-
-	UPROPERTY(meta = (BindWidget))
-	class UPanelWidget* ServerList;
-
-	TSubclassOf<class UUserWidget> ServerRowClass;
-
-	TOptional<uint32> SelectedIndex;
-
-	UFUNCTION()
-	void HostServer();
-
-	UFUNCTION()
-	void JoinServer();
-
-	UFUNCTION()
-	void QuitGame();
-
-	UFUNCTION()
-	void OpenHostMenu();
-
-	UFUNCTION()
-	void OpenJoinMenu();
-
-	UFUNCTION()
-	void OpenMainMenu();
-
-	void UpdateChildren();
-	
-};
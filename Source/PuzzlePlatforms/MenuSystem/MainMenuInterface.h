@@ -29,5 +29,8 @@ public:
 
 	virtual void LoadMainMenu() = 0;
 
-	virtual void RefreshingServerList() = 0;
+	/** Streams sessions to the menu as they are found, reusing a search already in flight unless bForceRestart is set. */
+	virtual void RefreshingServerList(bool bForceRestart = false) = 0;
+
+	virtual void CancelRefreshingServerList() = 0;
 };
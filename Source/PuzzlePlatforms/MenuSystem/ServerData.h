@@ -0,0 +1,47 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ServerData.generated.h"
+
+UENUM()
+enum class EServerSortMode : uint8 {
+
+	/** Order the sessions were found in. */
+	Discovery,
+
+	/** Lowest latency first, unmeasured hosts last. */
+	Ping,
+
+	/** Most populated first, full hosts last. */
+	Fill
+};
+
+USTRUCT()
+struct  FServerData {
+
+	GENERATED_BODY()
+
+	FString Name;
+
+	uint16 CurrentPlayers;
+
+	uint16 TotalPlayers;
+
+	FString HostUserName;
+
+	/** Stable identity of the session, used to update rows in place. */
+	FString SessionId;
+
+	/** Round-trip time to the host, INDEX_NONE until measured. */
+	int32 PingMs = INDEX_NONE;
+
+	bool IsFull() const { return CurrentPlayers >= TotalPlayers; }
+
+	bool operator==(const FServerData& Other) const {
+
+		return Name == Other.Name && CurrentPlayers == Other.CurrentPlayers && TotalPlayers == Other.TotalPlayers && HostUserName == Other.HostUserName && SessionId == Other.SessionId && PingMs == Other.PingMs;
+	}
+
+};
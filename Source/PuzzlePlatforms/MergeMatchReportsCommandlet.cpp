@@ -0,0 +1,101 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MergeMatchReportsCommandlet.h"
+#include "MatchReport.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+UMergeMatchReportsCommandlet::UMergeMatchReportsCommandlet() {
+
+	IsClient = false;
+
+	IsServer = false;
+
+	LogToConsole = true;
+}
+
+int32 UMergeMatchReportsCommandlet::Main(const FString& Params) {
+
+	FString Directory = FPaths::ProjectSavedDir() / TEXT("MatchReports");
+
+	FParse::Value(*Params, TEXT("Dir="), Directory);
+
+	FString OutPath = Directory / TEXT("Merged.json");
+
+	FParse::Value(*Params, TEXT("Out="), OutPath);
+
+	FString MapFilter;
+
+	FParse::Value(*Params, TEXT("Map="), MapFilter);
+
+	TArray<FString> Files;
+
+	IFileManager::Get().FindFiles(Files, *(Directory / TEXT("*.json")), true, false);
+
+	FMatchReport Merged;
+
+	Merged.NumMatches = 0;
+
+	Merged.MapName = MapFilter.IsEmpty() ? TEXT("All") : MapFilter;
+
+	int32 NumSkipped = 0;
+
+	for (const FString& File : Files) {
+
+		const FString Path = Directory / File;
+
+		if (FPaths::IsSamePath(Path, OutPath)) continue;
+
+		FString JsonString;
+
+		FMatchReport Report;
+
+		if (!FFileHelper::LoadFileToString(JsonString, *Path) || !Report.FromJsonString(JsonString)) {
+
+			UE_LOG(LogTemp, Warning, TEXT("Skipping unreadable report %s."), *File);
+
+			NumSkipped++;
+
+			continue;
+		}
+
+		if (!MapFilter.IsEmpty() && Report.MapName != MapFilter) continue;
+
+		if (Merged.StartTime.IsEmpty() || Report.StartTime < Merged.StartTime) {
+
+			Merged.StartTime = Report.StartTime;
+		}
+
+		Merged.Merge(Report);
+	}
+
+	if (Merged.NumMatches == 0) {
+
+		UE_LOG(LogTemp, Warning, TEXT("No match reports found in %s."), *Directory);
+
+		return 1;
+	}
+
+	if (!FFileHelper::SaveStringToFile(Merged.ToJsonString(), *OutPath)) {
+
+		UE_LOG(LogTemp, Error, TEXT("Could not write %s."), *OutPath);
+
+		return 1;
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("Merged %d matches (%d skipped), %.1f hours, %d joins, up to %d players."), Merged.NumMatches, NumSkipped, Merged.DurationSeconds / 3600.0, Merged.TotalJoins, Merged.MaxPlayers);
+
+	UE_LOG(LogTemp, Display, TEXT("Frame ms p50/p90/p99/max: %.2f/%.2f/%.2f/%.2f"), Merged.FrameTimes.Percentile(50.f), Merged.FrameTimes.Percentile(90.f), Merged.FrameTimes.Percentile(99.f), Merged.FrameTimes.MaxMs);
+
+	UE_LOG(LogTemp, Display, TEXT("Game thread ms p50/p90/p99/max: %.2f/%.2f/%.2f/%.2f"), Merged.GameThreadTimes.Percentile(50.f), Merged.GameThreadTimes.Percentile(90.f), Merged.GameThreadTimes.Percentile(99.f), Merged.GameThreadTimes.MaxMs);
+
+	UE_LOG(LogTemp, Display, TEXT("Join ms p50/p90/p99: %.0f/%.0f/%.0f"), Merged.JoinLatencies.Percentile(50.f), Merged.JoinLatencies.Percentile(90.f), Merged.JoinLatencies.Percentile(99.f));
+
+	UE_LOG(LogTemp, Display, TEXT("Corrections per minute: %.1f, %.1f of them on moving platforms."), Merged.GetCorrectionsPerMinute(), Merged.GetPlatformCorrectionsPerMinute());
+
+	UE_LOG(LogTemp, Display, TEXT("Moving platforms avg/max: %.1f/%d. Wrote %s."), Merged.GetAverageMovingPlatforms(), Merged.MaxMovingPlatforms, *OutPath);
+
+	return 0;
+}
@@ -0,0 +1,23 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "MergeMatchReportsCommandlet.generated.h"
+
+/**
+ * Merges the match reports written by FMatchRecorder into one report and logs the fleet-wide aggregates.
+ * Usage: -run=MergeMatchReports [-Dir=<report directory>] [-Out=<merged report>] [-Map=<only this map>]
+ */
+UCLASS()
+class PUZZLEPLATFORMS_API UMergeMatchReportsCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+
+	UMergeMatchReportsCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -2,10 +2,12 @@
 
 
 #include "MovingPlatform.h"
+#include "MovingPlatformSubsystem.h"
+#include "Net/UnrealNetwork.h"
 
 AMovingPlatform::AMovingPlatform() {
 
-	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bCanEverTick = false;
 
 	SetMobility(EComponentMobility::Movable);
 
@@ -13,66 +15,187 @@ AMovingPlatform::AMovingPlatform() {
 
 	ActiveTriggers = 0;
 
+	// Set on the class default, so the replication graph picks up the class and clients never see level copies as authority.
+	bReplicates = true;
+
+	NetDormancy = DORM_DormantAll;
+
 }
 
 void AMovingPlatform::BeginPlay() {
 	
 	Super::BeginPlay();
 
+	GlobalStartLocation = GetActorLocation();
+	GlobalTargetLocation = GetTransform().TransformPosition(TargetLocation);
+
+	UMovingPlatformSubsystem* Subsystem = GetPlatformSubsystem();
+
+	if (!ensure(Subsystem != nullptr)) return;
+
 	if (HasAuthority()) {
 
-		SetReplicates(true);
+		// Clients place the platform from NetState in both modes, so full FRepMovement updates would only duplicate it.
+		SetReplicateMovement(false);
+
+		bStreamNetState = !bDeterministicMotion;
+
+		Motion.StartLocation = GlobalStartLocation;
+		Motion.TargetLocation = GlobalTargetLocation;
+		Motion.Speed = Speed;
+		Motion.PhaseAnchor = 0.f;
+		Motion.TimeAnchor = Subsystem->GetSimulationTime();
+		Motion.bMoving = ActiveTriggers > 0;
+
+		Subsystem->RegisterPlatform(this, Motion, ActiveTriggers, BakePath(), Easing);
 
-		SetReplicateMovement(true);
+		NetState = Subsystem->GetNetState(PlatformIndex, Motion.TimeAnchor);
+
+		if (bStreamNetState && Motion.bMoving) {
+
+			SetNetDormancy(DORM_Awake);
+		}
 	}
+	else {
 
-	GlobalStartLocation = GetActorLocation();
-	GlobalTargetLocation = GetTransform().TransformPosition(TargetLocation);
+		// Motion may not have replicated yet, and a zero start location would snap the platform to the origin.
+		if (!bMotionReceived) {
 
-	
+			Motion.StartLocation = GlobalStartLocation;
+			Motion.TargetLocation = GlobalTargetLocation;
+			Motion.Speed = Speed;
+		}
+
+		Motion.bMoving = NetState.bActive;
+
+		Subsystem->RegisterPlatform(this, Motion, 0, BakePath(), Easing);
+
+		Subsystem->SetNetState(PlatformIndex, NetState);
+	}
 }
 
-void AMovingPlatform::Tick(float DeltaTime) {
-	
-	Super::Tick(DeltaTime);
+void AMovingPlatform::EndPlay(const EEndPlayReason::Type EndPlayReason) {
 
-	if (ActiveTriggers > 0) {
+	UMovingPlatformSubsystem* Subsystem = GetPlatformSubsystem();
 
-		if (HasAuthority()) {
+	if (Subsystem != nullptr) {
 
-			FVector Location = GetActorLocation();
+		Subsystem->UnregisterPlatform(this);
+	}
 
-			float JourneyLength = (GlobalTargetLocation - GlobalStartLocation).Size();
+	Super::EndPlay(EndPlayReason);
+}
+
+void AMovingPlatform::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const {
 
-			float JourneyTravel = (Location - GlobalStartLocation).Size();
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
-			if (JourneyTravel > JourneyLength) {
+	DOREPLIFETIME_CONDITION(AMovingPlatform, Motion, COND_InitialOnly);
 
-				FVector Swap = GlobalStartLocation;
+	DOREPLIFETIME(AMovingPlatform, NetState);
 
-				GlobalStartLocation = GlobalTargetLocation;
+	DOREPLIFETIME_CONDITION(AMovingPlatform, Easing, COND_InitialOnly);
 
-				GlobalTargetLocation = Swap;
-			}
+	DOREPLIFETIME_CONDITION(AMovingPlatform, PathMode, COND_InitialOnly);
 
-			FVector Direction = (GlobalTargetLocation - GlobalStartLocation).GetSafeNormal();
+	DOREPLIFETIME_CONDITION(AMovingPlatform, Waypoints, COND_InitialOnly);
+}
 
-			Location += Speed * DeltaTime * Direction;
+void AMovingPlatform::OnNetStateChanged(const FPlatformNetState& NewNetState) {
 
-			SetActorLocation(Location);
-		}
+	NetState = NewNetState;
+
+	if (bStreamNetState) {
+
+		SetNetDormancy(NetState.bActive ? DORM_Awake : DORM_DormantAll);
 	}
+	else {
 
-	
+		FlushNetDormancy();
+	}
+}
+
+void AMovingPlatform::OnRep_Motion() {
+
+	bMotionReceived = true;
+
+	ApplyReplicatedState();
+}
+
+void AMovingPlatform::OnRep_NetState() {
+
+	ApplyReplicatedState();
+}
+
+void AMovingPlatform::ApplyReplicatedState() {
+
+	if (PlatformIndex == INDEX_NONE) return;
+
+	// The journey length NetState is relative to comes from Motion, so the two are always applied together.
+	UMovingPlatformSubsystem* Subsystem = GetPlatformSubsystem();
+
+	// bMoving is not replicated; taking it from NetState keeps SetMotion from snapping a platform that is under way.
+	Motion.bMoving = NetState.bActive;
+
+	Subsystem->SetMotion(PlatformIndex, Motion);
+
+	Subsystem->SetNetState(PlatformIndex, NetState);
 }
 
 void AMovingPlatform::AddActiveTrigger() {
+
+	if (!HasAuthority()) return;
+
 	ActiveTriggers++;
+
+	if (PlatformIndex != INDEX_NONE) {
+
+		GetPlatformSubsystem()->AddActiveTrigger(PlatformIndex);
+	}
 }
 
 void AMovingPlatform::RemoveActiveTrigger() {
+
+	if (!HasAuthority()) return;
 	
 	if (ActiveTriggers > 0) {
 		ActiveTriggers--;
-	}	
-}
\ No newline at end of file
+	}
+
+	if (PlatformIndex != INDEX_NONE) {
+
+		GetPlatformSubsystem()->RemoveActiveTrigger(PlatformIndex);
+	}
+}
+
+UMovingPlatformSubsystem* AMovingPlatform::GetPlatformSubsystem() const {
+
+	UWorld* World = GetWorld();
+
+	return World != nullptr ? World->GetSubsystem<UMovingPlatformSubsystem>() : nullptr;
+}
+
+FPlatformPath AMovingPlatform::BakePath() const {
+
+	FPlatformPath Path;
+
+	if (PathMode != EPlatformPathMode::Spline) return Path;
+
+	// Baked relative to the path start, so clients only need the replicated start location to place it.
+	const FTransform& Transform = GetTransform();
+
+	TArray<FVector> Points;
+
+	Points.Add(FVector::ZeroVector);
+
+	for (const FVector& Waypoint : Waypoints) {
+
+		Points.Add(Transform.TransformVector(Waypoint));
+	}
+
+	Points.Add(Transform.TransformVector(TargetLocation));
+
+	Path.Bake(Points, PathSampleSpacing);
+
+	return Path;
+}
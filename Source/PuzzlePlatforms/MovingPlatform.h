@@ -4,10 +4,12 @@
 
 #include "CoreMinimal.h"
 #include "Engine/StaticMeshActor.h"
+#include "PlatformMotion.h"
+#include "PlatformPath.h"
 #include "MovingPlatform.generated.h"
 
 /**
- * 
+ * Authoring surface for a moving platform. The motion itself is simulated by UMovingPlatformSubsystem.
  */
 UCLASS()
 class PUZZLEPLATFORMS_API AMovingPlatform : public AStaticMeshActor
@@ -20,7 +22,9 @@ public:
 
 	virtual void BeginPlay() override;
 
-	virtual void Tick(float DeltaTime) override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 
 	void AddActiveTrigger();
 
@@ -29,11 +33,33 @@ public:
 	UPROPERTY(EditAnywhere, Category = "Movement")
 	float Speed;
 
+	UPROPERTY(EditAnywhere, Category = "Movement", Replicated)
+	EPlatformEasing Easing = EPlatformEasing::Linear;
+
 	UPROPERTY(EditAnywhere, Category = "Position", Meta = (MakeEditWidget = true))
 	FVector TargetLocation;
 
+	UPROPERTY(EditAnywhere, Category = "Position", Replicated)
+	EPlatformPathMode PathMode = EPlatformPathMode::Linear;
+
+	/** Points the spline passes through between the platform and TargetLocation. */
+	UPROPERTY(EditAnywhere, Category = "Position", Replicated, Meta = (MakeEditWidget = true, EditCondition = "PathMode == EPlatformPathMode::Spline"))
+	TArray<FVector> Waypoints;
+
+	/** Arc-length resolution of the baked spline lookup table. */
+	UPROPERTY(EditAnywhere, Category = "Position", AdvancedDisplay, Meta = (ClampMin = 1, EditCondition = "PathMode == EPlatformPathMode::Spline"))
+	float PathSampleSpacing = 10.f;
+
+	/** Replicate NetState only when the platform starts or stops, and let clients evaluate the position in between, instead of streaming NetState every net update. */
+	UPROPERTY(EditAnywhere, Category = "Replication")
+	bool bDeterministicMotion = true;
+
+	void OnNetStateChanged(const FPlatformNetState& NewNetState);
+
 private:
 
+	friend class UMovingPlatformSubsystem;
+
 	FVector GlobalTargetLocation;
 
 	FVector GlobalStartLocation;
@@ -41,6 +67,32 @@ private:
 	UPROPERTY(EditAnywhere, Category = "Triggers")
 	int ActiveTriggers;
 
+	UPROPERTY(ReplicatedUsing = OnRep_Motion)
+	FPlatformMotion Motion;
+
+	UPROPERTY(ReplicatedUsing = OnRep_NetState)
+	FPlatformNetState NetState;
+
+	/** Set on the server for platforms without deterministic motion; the subsystem refreshes NetState every frame while they move. */
+	bool bStreamNetState = false;
+
+	/** Set on clients once Motion has replicated; until then BeginPlay seeds it from the level placement. */
+	bool bMotionReceived = false;
+
+	UFUNCTION()
+	void OnRep_Motion();
+
+	UFUNCTION()
+	void OnRep_NetState();
+
+	void ApplyReplicatedState();
+
+	int32 PlatformIndex = INDEX_NONE;
+
+	class UMovingPlatformSubsystem* GetPlatformSubsystem() const;
+
+	FPlatformPath BakePath() const;
+
 };
 
 
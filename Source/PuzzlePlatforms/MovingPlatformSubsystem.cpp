@@ -0,0 +1,596 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MovingPlatformSubsystem.h"
+#include "PuzzlePlatforms.h"
+#include "MovingPlatform.h"
+#include "GameFramework/GameStateBase.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/Pawn.h"
+#include "UObject/CoreNet.h"
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+DECLARE_CYCLE_STAT(TEXT("Moving Platform Simulation"), STAT_MovingPlatformSimulation, STATGROUP_PuzzlePlatforms);
+DECLARE_CYCLE_STAT(TEXT("Moving Platform Compute"), STAT_MovingPlatformCompute, STATGROUP_PuzzlePlatforms);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Registered Platforms"), STAT_RegisteredPlatforms, STATGROUP_PuzzlePlatforms);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Active Platforms"), STAT_ActivePlatforms, STATGROUP_PuzzlePlatforms);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Platform Updates"), STAT_PlatformUpdates, STATGROUP_PuzzlePlatforms);
+
+bool UMovingPlatformSubsystem::ShouldCreateSubsystem(UObject* Outer) const {
+
+	UWorld* World = Cast<UWorld>(Outer);
+
+	return World != nullptr && World->IsGameWorld();
+}
+
+void UMovingPlatformSubsystem::Initialize(FSubsystemCollectionBase& Collection) {
+
+	Super::Initialize(Collection);
+
+	UWorld* World = GetWorld();
+
+	if (!ensure(World != nullptr && World->PersistentLevel != nullptr)) return;
+
+	TickFunction.Subsystem = this;
+	TickFunction.TickGroup = TG_PrePhysics;
+	TickFunction.bHighPriority = true;
+	TickFunction.bCanEverTick = true;
+
+	// Enabled by UpdateMovingSlot while at least one platform moves.
+	TickFunction.SetTickFunctionEnable(false);
+
+	TickFunction.RegisterTickFunction(World->PersistentLevel);
+}
+
+void UMovingPlatformSubsystem::Deinitialize() {
+
+	if (TickFunction.IsTickFunctionRegistered()) {
+
+		TickFunction.UnRegisterTickFunction();
+	}
+
+	TickFunction.Subsystem = nullptr;
+
+	DEC_DWORD_STAT_BY(STAT_RegisteredPlatforms, Platforms.Num());
+
+	DEC_DWORD_STAT_BY(STAT_ActivePlatforms, MovingPlatforms.Num());
+
+	for (AMovingPlatform* Platform : Platforms) {
+
+		if (Platform != nullptr) {
+
+			Platform->PlatformIndex = INDEX_NONE;
+		}
+	}
+
+	Platforms.Empty();
+	StartLocations.Empty();
+	TargetLocations.Empty();
+	Directions.Empty();
+	Paths.Empty();
+	Easings.Empty();
+	JourneyLengths.Empty();
+	Speeds.Empty();
+	PhaseAnchors.Empty();
+	TimeAnchors.Empty();
+	Moving.Empty();
+	ActiveTriggers.Empty();
+	MovingSlots.Empty();
+	MovingPlatforms.Empty();
+	NextUpdateTimes.Empty();
+	UpdateIntervals.Empty();
+
+	Super::Deinitialize();
+}
+
+void UMovingPlatformSubsystem::RegisterPlatform(AMovingPlatform* Platform, const FPlatformMotion& Motion, int32 InitialTriggers, FPlatformPath&& Path, EPlatformEasing Easing) {
+
+	if (!ensure(Platform != nullptr)) return;
+
+	if (!ensure(Platform->PlatformIndex == INDEX_NONE)) return;
+
+	Platform->PlatformIndex = Platforms.Add(Platform);
+
+	INC_DWORD_STAT(STAT_RegisteredPlatforms);
+
+	StartLocations.AddDefaulted();
+	TargetLocations.AddDefaulted();
+	Directions.AddDefaulted();
+	Paths.Add(MoveTemp(Path));
+	Easings.Add(Easing);
+	JourneyLengths.AddDefaulted();
+	Speeds.AddDefaulted();
+	PhaseAnchors.AddDefaulted();
+	TimeAnchors.AddDefaulted();
+	Moving.AddDefaulted();
+	ActiveTriggers.Add(InitialTriggers);
+	MovingSlots.Add(INDEX_NONE);
+	NextUpdateTimes.Add(0.f);
+	UpdateIntervals.Add(0.f);
+
+	SetMotion(Platform->PlatformIndex, Motion);
+}
+
+void UMovingPlatformSubsystem::UnregisterPlatform(AMovingPlatform* Platform) {
+
+	if (Platform == nullptr || !Platforms.IsValidIndex(Platform->PlatformIndex)) return;
+
+	const int32 Index = Platform->PlatformIndex;
+
+	if (!ensure(Platforms[Index] == Platform)) return;
+
+	Moving[Index] = false;
+
+	UpdateMovingSlot(Index);
+
+	DEC_DWORD_STAT(STAT_RegisteredPlatforms);
+
+	Platforms.RemoveAtSwap(Index, 1, false);
+	StartLocations.RemoveAtSwap(Index, 1, false);
+	TargetLocations.RemoveAtSwap(Index, 1, false);
+	Directions.RemoveAtSwap(Index, 1, false);
+	Paths.RemoveAtSwap(Index, 1, false);
+	Easings.RemoveAtSwap(Index, 1, false);
+	JourneyLengths.RemoveAtSwap(Index, 1, false);
+	Speeds.RemoveAtSwap(Index, 1, false);
+	PhaseAnchors.RemoveAtSwap(Index, 1, false);
+	TimeAnchors.RemoveAtSwap(Index, 1, false);
+	Moving.RemoveAtSwap(Index, 1, false);
+	ActiveTriggers.RemoveAtSwap(Index, 1, false);
+	MovingSlots.RemoveAtSwap(Index, 1, false);
+	NextUpdateTimes.RemoveAtSwap(Index, 1, false);
+	UpdateIntervals.RemoveAtSwap(Index, 1, false);
+
+	if (Platforms.IsValidIndex(Index)) {
+
+		Platforms[Index]->PlatformIndex = Index;
+
+		if (MovingSlots[Index] != INDEX_NONE) {
+
+			MovingPlatforms[MovingSlots[Index]] = Index;
+		}
+	}
+
+	Platform->PlatformIndex = INDEX_NONE;
+}
+
+void UMovingPlatformSubsystem::SetMotion(int32 Index, const FPlatformMotion& Motion) {
+
+	if (!ensure(Platforms.IsValidIndex(Index))) return;
+
+	const FVector Journey = Motion.TargetLocation - Motion.StartLocation;
+
+	StartLocations[Index] = Motion.StartLocation;
+	TargetLocations[Index] = Motion.TargetLocation;
+	Directions[Index] = Journey.GetSafeNormal();
+	JourneyLengths[Index] = Paths[Index].IsBaked() ? Paths[Index].Length : Journey.Size();
+	Speeds[Index] = Motion.Speed;
+	PhaseAnchors[Index] = Motion.PhaseAnchor;
+	TimeAnchors[Index] = Motion.TimeAnchor;
+	Moving[Index] = Motion.bMoving;
+
+	UpdateMovingSlot(Index);
+
+	if (!Motion.bMoving) {
+
+		SnapToAnchor(Index);
+	}
+}
+
+FPlatformMotion UMovingPlatformSubsystem::GetMotion(int32 Index) const {
+
+	FPlatformMotion Motion;
+
+	if (!ensure(Platforms.IsValidIndex(Index))) return Motion;
+
+	Motion.StartLocation = StartLocations[Index];
+	Motion.TargetLocation = TargetLocations[Index];
+	Motion.Speed = Speeds[Index];
+	Motion.PhaseAnchor = PhaseAnchors[Index];
+	Motion.TimeAnchor = TimeAnchors[Index];
+	Motion.bMoving = Moving[Index];
+
+	return Motion;
+}
+
+void UMovingPlatformSubsystem::SetNetState(int32 Index, const FPlatformNetState& NetState) {
+
+	if (!ensure(Platforms.IsValidIndex(Index))) return;
+
+	PhaseAnchors[Index] = NetState.ToPhase(JourneyLengths[Index]);
+	TimeAnchors[Index] = NetState.Timestamp;
+	Moving[Index] = NetState.bActive;
+
+	UpdateMovingSlot(Index);
+
+	if (!NetState.bActive) {
+
+		SnapToAnchor(Index);
+	}
+}
+
+FPlatformNetState UMovingPlatformSubsystem::GetNetState(int32 Index, float Time) const {
+
+	if (!ensure(Platforms.IsValidIndex(Index))) return FPlatformNetState();
+
+	return FPlatformNetState::FromPhase(EvaluatePhase(Index, Time), JourneyLengths[Index], Moving[Index], Time);
+}
+
+void UMovingPlatformSubsystem::AddActiveTrigger(int32 Index) {
+
+	if (!ensure(ActiveTriggers.IsValidIndex(Index))) return;
+
+	if (++ActiveTriggers[Index] == 1) {
+
+		SetMoving(Index, true);
+	}
+}
+
+void UMovingPlatformSubsystem::RemoveActiveTrigger(int32 Index) {
+
+	if (!ensure(ActiveTriggers.IsValidIndex(Index))) return;
+
+	if (ActiveTriggers[Index] > 0 && --ActiveTriggers[Index] == 0) {
+
+		SetMoving(Index, false);
+	}
+}
+
+void UMovingPlatformSubsystem::SetMoving(int32 Index, bool bMoving) {
+
+	const float Now = GetSimulationTime();
+
+	const FPlatformNetState NetState = FPlatformNetState::FromPhase(EvaluatePhase(Index, Now), JourneyLengths[Index], bMoving, Now);
+
+	// Anchor on the quantized phase, so the server follows exactly the motion clients rebuild from NetState.
+	PhaseAnchors[Index] = NetState.ToPhase(JourneyLengths[Index]);
+	TimeAnchors[Index] = Now;
+	Moving[Index] = bMoving;
+
+	UpdateMovingSlot(Index);
+
+	if (!bMoving) {
+
+		SnapToAnchor(Index);
+	}
+
+	Platforms[Index]->OnNetStateChanged(NetState);
+}
+
+void UMovingPlatformSubsystem::UpdateMovingSlot(int32 Index) {
+
+	const bool bShouldMove = Moving[Index] && JourneyLengths[Index] > KINDA_SMALL_NUMBER;
+
+	const int32 Slot = MovingSlots[Index];
+
+	if (bShouldMove && Slot == INDEX_NONE) {
+
+		MovingSlots[Index] = MovingPlatforms.Add(Index);
+
+		NextUpdateTimes[Index] = 0.f;
+
+		INC_DWORD_STAT(STAT_ActivePlatforms);
+
+		if (MovingPlatforms.Num() == 1) {
+
+			TickFunction.SetTickFunctionEnable(true);
+		}
+	}
+	else if (!bShouldMove && Slot != INDEX_NONE) {
+
+		MovingPlatforms.RemoveAtSwap(Slot, 1, false);
+
+		if (MovingPlatforms.IsValidIndex(Slot)) {
+
+			MovingSlots[MovingPlatforms[Slot]] = Slot;
+		}
+
+		MovingSlots[Index] = INDEX_NONE;
+
+		DEC_DWORD_STAT(STAT_ActivePlatforms);
+
+		if (MovingPlatforms.Num() == 0) {
+
+			TickFunction.SetTickFunctionEnable(false);
+		}
+	}
+}
+
+void UMovingPlatformSubsystem::UpdateSignificance(float Now) {
+
+	NextSignificanceTime = Now + SignificanceInterval;
+
+	TArray<FVector, TInlineAllocator<16>> PawnLocations;
+
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It) {
+
+		const APawn* Pawn = It->IsValid() ? (*It)->GetPawn() : nullptr;
+
+		if (Pawn != nullptr) {
+
+			PawnLocations.Add(Pawn->GetActorLocation());
+		}
+	}
+
+	const float NearDistanceSquared = FMath::Square(NearDistance);
+
+	const float DistanceRange = FMath::Max(FarDistance - NearDistance, 1.f);
+
+	for (const int32 i : MovingPlatforms) {
+
+		const FVector Location = Platforms[i]->GetActorLocation();
+
+		float NearestSquared = MAX_flt;
+
+		for (const FVector& PawnLocation : PawnLocations) {
+
+			NearestSquared = FMath::Min(NearestSquared, FVector::DistSquared(Location, PawnLocation));
+		}
+
+		if (NearestSquared <= NearDistanceSquared) {
+
+			UpdateIntervals[i] = 0.f;
+
+			// Catch up at once when a player comes close to a platform that was updated rarely.
+			NextUpdateTimes[i] = FMath::Min(NextUpdateTimes[i], Now);
+		}
+		else {
+
+			const float Alpha = FMath::Min((FMath::Sqrt(NearestSquared) - NearDistance) / DistanceRange, 1.f);
+
+			UpdateIntervals[i] = Alpha * MaxUpdateInterval;
+		}
+	}
+}
+
+void UMovingPlatformSubsystem::SnapToAnchor(int32 Index) {
+
+	if (JourneyLengths[Index] > KINDA_SMALL_NUMBER) {
+
+		Platforms[Index]->SetActorLocation(EvaluateLocation(Index, PhaseAnchors[Index]));
+	}
+}
+
+float UMovingPlatformSubsystem::EvaluatePhase(int32 Index, float Time) const {
+
+	return FPlatformMotion::EvaluatePhase(PhaseAnchors[Index], TimeAnchors[Index], Speeds[Index], Moving[Index], 2.f * JourneyLengths[Index], Time);
+}
+
+FVector UMovingPlatformSubsystem::EvaluateLocation(int32 Index, float Phase) const {
+
+	const float JourneyLength = JourneyLengths[Index];
+
+	float JourneyTravel = FPlatformMotion::PhaseToJourneyTravel(Phase, JourneyLength);
+
+	if (Easings[Index] != EPlatformEasing::Linear) {
+
+		JourneyTravel = FPlatformPath::Ease(Easings[Index], JourneyTravel / JourneyLength) * JourneyLength;
+	}
+
+	const FPlatformPath& Path = Paths[Index];
+
+	return StartLocations[Index] + (Path.IsBaked() ? Path.Evaluate(JourneyTravel) : Directions[Index] * JourneyTravel);
+}
+
+void UMovingPlatformSubsystem::ReportNetCost() const {
+
+	const float Now = GetSimulationTime();
+
+	const float VelocitySampleTime = 0.01f;
+
+	int64 RepMovementBits = 0;
+
+	int64 NetStateBits = 0;
+
+	double RepMovementBytesPerSecond = 0.0;
+
+	double NetStateBytesPerSecond = 0.0;
+
+	for (int32 i = 0; i < Platforms.Num(); i++) {
+
+		const AMovingPlatform* Platform = Platforms[i];
+
+		const FVector Location = EvaluateLocation(i, EvaluatePhase(i, Now));
+
+		FRepMovement RepMovement;
+
+		RepMovement.Location = Location;
+		RepMovement.Rotation = Platform->GetActorRotation();
+		RepMovement.LinearVelocity = (EvaluateLocation(i, EvaluatePhase(i, Now + VelocitySampleTime)) - Location) / VelocitySampleTime;
+
+		bool bSuccess = false;
+
+		FNetBitWriter RepMovementWriter(nullptr, 1024);
+
+		RepMovement.NetSerialize(RepMovementWriter, nullptr, bSuccess);
+
+		FPlatformNetState State = GetNetState(i, Now);
+
+		FNetBitWriter NetStateWriter(nullptr, 1024);
+
+		State.NetSerialize(NetStateWriter, nullptr, bSuccess);
+
+		RepMovementBits += RepMovementWriter.GetNumBits();
+
+		NetStateBits += NetStateWriter.GetNumBits();
+
+		RepMovementBytesPerSecond += RepMovementWriter.GetNumBits() / 8.0 * Platform->NetUpdateFrequency;
+
+		NetStateBytesPerSecond += NetStateWriter.GetNumBits() / 8.0 * Platform->NetUpdateFrequency;
+	}
+
+	const int32 NumPlatforms = FMath::Max(Platforms.Num(), 1);
+
+	UE_LOG(LogTemp, Warning, TEXT("Platform net cost over %d platforms: FRepMovement %.1f bits (%.1f B/s while moving), NetState %.1f bits (%.1f B/s streamed, one update per start or stop when deterministic)."),
+		Platforms.Num(),
+		double(RepMovementBits) / NumPlatforms, RepMovementBytesPerSecond / NumPlatforms,
+		double(NetStateBits) / NumPlatforms, NetStateBytesPerSecond / NumPlatforms);
+}
+
+float UMovingPlatformSubsystem::GetSimulationTime() const {
+
+	UWorld* World = GetWorld();
+
+	if (World == nullptr) return 0.f;
+
+	AGameStateBase* GameState = World->GetGameState();
+
+	return GameState != nullptr ? GameState->GetServerWorldTimeSeconds() : World->GetTimeSeconds();
+}
+
+void UMovingPlatformSubsystem::Tick(float DeltaTime) {
+
+	SCOPE_CYCLE_COUNTER(STAT_MovingPlatformSimulation);
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(UMovingPlatformSubsystem::Tick);
+
+	const float Now = GetSimulationTime();
+
+	if (bScaleUpdateIntervals && Now >= NextSignificanceTime) {
+
+		UpdateSignificance(Now);
+	}
+
+	DueIndices.Reset();
+
+	for (const int32 i : MovingPlatforms) {
+
+		if (NextUpdateTimes[i] > Now) continue;
+
+		NextUpdateTimes[i] = Now + UpdateIntervals[i];
+
+		DueIndices.Add(i);
+	}
+
+	const int32 NumDue = DueIndices.Num();
+
+	INC_DWORD_STAT_BY(STAT_PlatformUpdates, NumDue);
+
+	const bool bParallel = bParallelUpdate && NumDue >= ParallelUpdateMinPlatforms;
+
+	ComputeDueLocations(Now, bParallel ? FMath::DivideAndRoundUp(NumDue, FMath::Max(ParallelUpdateChunkSize, 1)) : 1);
+
+	// Apply on the game thread, the only place actors may be moved.
+	for (int32 Due = 0; Due < NumDue; Due++) {
+
+		const int32 i = DueIndices[Due];
+
+		AMovingPlatform* Platform = Platforms[i];
+
+		Platform->SetActorLocation(DueLocations[Due]);
+
+		if (Platform->bStreamNetState) {
+
+			Platform->NetState = FPlatformNetState::FromPhase(DuePhases[Due], JourneyLengths[i], true, Now);
+		}
+	}
+}
+
+void UMovingPlatformSubsystem::ComputeDueLocations(float Now, int32 NumChunks) {
+
+	SCOPE_CYCLE_COUNTER(STAT_MovingPlatformCompute);
+
+	const int32 NumDue = DueIndices.Num();
+
+	DuePhases.SetNumUninitialized(NumDue, false);
+
+	DueLocations.SetNumUninitialized(NumDue, false);
+
+	NumChunks = FMath::Clamp(NumChunks, 1, FMath::Max(NumDue, 1));
+
+	const int32 ChunkSize = FMath::DivideAndRoundUp(NumDue, NumChunks);
+
+	// Every platform runs the same code on its own slots whichever chunk it lands in, so results match the serial pass.
+	ParallelFor(NumChunks, [this, Now, NumDue, ChunkSize](int32 Chunk) {
+
+		const int32 End = FMath::Min(NumDue, (Chunk + 1) * ChunkSize);
+
+		for (int32 Due = Chunk * ChunkSize; Due < End; Due++) {
+
+			const int32 i = DueIndices[Due];
+
+			const float Phase = EvaluatePhase(i, Now);
+
+			DuePhases[Due] = Phase;
+
+			DueLocations[Due] = EvaluateLocation(i, Phase);
+		}
+	}, NumChunks == 1);
+}
+
+void UMovingPlatformSubsystem::RunUpdateBenchmark(int32 NumFrames) {
+
+	const int32 NumPlatforms = Platforms.Num();
+
+	if (NumPlatforms == 0) {
+
+		UE_LOG(LogTemp, Warning, TEXT("Platform update benchmark: no platforms registered, spawn some with StressSpawn first."));
+		return;
+	}
+
+	NumFrames = FMath::Max(1, NumFrames);
+
+	const float StartTime = GetSimulationTime();
+
+	const float FrameTime = 1.f / 60.f;
+
+	DueIndices.Reset();
+
+	for (int32 i = 0; i < NumPlatforms; i++) {
+
+		DueIndices.Add(i);
+	}
+
+	auto RunFrames = [this, NumFrames, StartTime, FrameTime](int32 NumChunks) {
+
+		const double Start = FPlatformTime::Seconds();
+
+		for (int32 Frame = 0; Frame < NumFrames; Frame++) {
+
+			ComputeDueLocations(StartTime + Frame * FrameTime, NumChunks);
+		}
+
+		return (FPlatformTime::Seconds() - Start) * 1000.0 / NumFrames;
+	};
+
+	const double SerialMs = RunFrames(1);
+
+	const TArray<FVector> SerialLocations = DueLocations;
+
+	const TArray<float> SerialPhases = DuePhases;
+
+	UE_LOG(LogTemp, Warning, TEXT("Platform update benchmark: %d platforms x %d frames"), NumPlatforms, NumFrames);
+	UE_LOG(LogTemp, Warning, TEXT("  Serial:     %.3f ms per frame"), SerialMs);
+
+	// The game thread takes part in ParallelFor, so there is one more thread than task graph workers.
+	const int32 MaxWorkers = FTaskGraphInterface::Get().GetNumWorkerThreads() + 1;
+
+	for (int32 Workers = 1; ; Workers = FMath::Min(Workers * 2, MaxWorkers)) {
+
+		const double ParallelMs = RunFrames(Workers);
+
+		const bool bIdentical = FMemory::Memcmp(DueLocations.GetData(), SerialLocations.GetData(), NumPlatforms * sizeof(FVector)) == 0
+			&& FMemory::Memcmp(DuePhases.GetData(), SerialPhases.GetData(), NumPlatforms * sizeof(float)) == 0;
+
+		UE_LOG(LogTemp, Warning, TEXT("  %2d workers: %.3f ms per frame, %.2fx, %s"), Workers, ParallelMs, ParallelMs > 0.0 ? SerialMs / ParallelMs : 0.0, bIdentical ? TEXT("identical") : TEXT("RESULTS DIFFER"));
+
+		if (Workers == MaxWorkers) break;
+	}
+
+	DueIndices.Reset();
+}
+
+void FMovingPlatformTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) {
+
+	if (Subsystem != nullptr && TickType != LEVELTICK_ViewportsOnly) {
+
+		Subsystem->Tick(DeltaTime);
+	}
+}
+
+FString FMovingPlatformTickFunction::DiagnosticMessage() {
+
+	return TEXT("UMovingPlatformSubsystem::Tick");
+}
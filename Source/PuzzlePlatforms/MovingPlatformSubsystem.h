@@ -0,0 +1,181 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Engine/EngineBaseTypes.h"
+#include "PlatformMotion.h"
+#include "PlatformPath.h"
+#include "MovingPlatformSubsystem.generated.h"
+
+/** Runs UMovingPlatformSubsystem::Tick in the world's tick graph, so character movement can tick after it. */
+struct FMovingPlatformTickFunction : public FTickFunction {
+
+	class UMovingPlatformSubsystem* Subsystem = nullptr;
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+
+	virtual FString DiagnosticMessage() override;
+};
+
+/**
+ * Simulates every AMovingPlatform of a game world in a single pass per frame.
+ * Platform state lives in flat arrays indexed by AMovingPlatform::PlatformIndex.
+ * Positions are a pure function of server world time, so clients reproduce them from the replicated FPlatformMotion
+ * and FPlatformNetState.
+ * Only platforms that are currently moving are visited each frame; the subsystem stops ticking when none are.
+ * It ticks early in TG_PrePhysics, so characters standing on a platform move against its position for this frame.
+ * Platforms far from every player pawn are updated at longer intervals; since positions are evaluated from time,
+ * skipping frames never loses a platform's place along its path.
+ */
+UCLASS(Config = Game)
+class PUZZLEPLATFORMS_API UMovingPlatformSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	virtual void Deinitialize() override;
+
+	void RegisterPlatform(class AMovingPlatform* Platform, const FPlatformMotion& Motion, int32 ActiveTriggers, FPlatformPath&& Path, EPlatformEasing Easing);
+
+	void UnregisterPlatform(class AMovingPlatform* Platform);
+
+	void SetMotion(int32 Index, const FPlatformMotion& Motion);
+
+	FPlatformMotion GetMotion(int32 Index) const;
+
+	/** Re-anchors a platform on a replicated state. Needs the platform's motion to be set first. */
+	void SetNetState(int32 Index, const FPlatformNetState& NetState);
+
+	FPlatformNetState GetNetState(int32 Index, float Time) const;
+
+	void AddActiveTrigger(int32 Index);
+
+	void RemoveActiveTrigger(int32 Index);
+
+	int32 GetNumPlatforms() const { return Platforms.Num(); }
+
+	int32 GetNumMovingPlatforms() const { return MovingPlatforms.Num(); }
+
+	/**
+	 * Logs the serialized size of each platform's NetState against the FRepMovement replicated movement would send
+	 * for the same pose, and the bytes per second either costs a moving platform at its net update frequency.
+	 */
+	void ReportNetCost() const;
+
+	/** Server world time, the clock all platform motion is evaluated against. */
+	float GetSimulationTime() const;
+
+	void Tick(float DeltaTime);
+
+	/**
+	 * Times the location phase of the update over every registered platform for NumFrames frames, serially and
+	 * split across 1, 2, 4... task graph workers, checks each split gives the serial results and logs the timings.
+	 */
+	void RunUpdateBenchmark(int32 NumFrames);
+
+	/** Tick functions that read platform positions add this as a prerequisite. */
+	FTickFunction& GetTickFunction() { return TickFunction; }
+
+private:
+
+	UPROPERTY()
+	TArray<class AMovingPlatform*> Platforms;
+
+	TArray<FVector> StartLocations;
+
+	TArray<FVector> TargetLocations;
+
+	TArray<FVector> Directions;
+
+	/** Baked curve for spline platforms, empty for straight-line ones. */
+	TArray<FPlatformPath> Paths;
+
+	TArray<EPlatformEasing> Easings;
+
+	TArray<float> JourneyLengths;
+
+	TArray<float> Speeds;
+
+	TArray<float> PhaseAnchors;
+
+	TArray<float> TimeAnchors;
+
+	TArray<bool> Moving;
+
+	TArray<int32> ActiveTriggers;
+
+	/** Slot of each platform in MovingPlatforms, or INDEX_NONE while it is asleep. */
+	TArray<int32> MovingSlots;
+
+	/** Indices of the platforms that are currently moving. */
+	TArray<int32> MovingPlatforms;
+
+	/** Simulation time each platform is next moved at. */
+	TArray<float> NextUpdateTimes;
+
+	/** Seconds between moves of each platform, from its distance to the nearest player pawn; 0 moves it every frame. */
+	TArray<float> UpdateIntervals;
+
+	float NextSignificanceTime = 0.f;
+
+	UPROPERTY(Config)
+	bool bScaleUpdateIntervals = true;
+
+	/** Platforms closer than this to a player pawn move every frame. */
+	UPROPERTY(Config)
+	float NearDistance = 3000.f;
+
+	/** Platforms at least this far from every player pawn move every MaxUpdateInterval seconds. */
+	UPROPERTY(Config)
+	float FarDistance = 15000.f;
+
+	UPROPERTY(Config)
+	float MaxUpdateInterval = 0.5f;
+
+	/** How often update intervals are recomputed from player positions. */
+	UPROPERTY(Config)
+	float SignificanceInterval = 0.25f;
+
+	/** Compute the new platform locations on task graph workers when at least ParallelUpdateMinPlatforms are due. */
+	UPROPERTY(Config)
+	bool bParallelUpdate = true;
+
+	UPROPERTY(Config)
+	int32 ParallelUpdateMinPlatforms = 512;
+
+	/** Platforms per task in the parallel phase. */
+	UPROPERTY(Config)
+	int32 ParallelUpdateChunkSize = 256;
+
+	/** Platforms due for a move this frame, and the phase and location computed for each. */
+	TArray<int32> DueIndices;
+
+	TArray<float> DuePhases;
+
+	TArray<FVector> DueLocations;
+
+	FMovingPlatformTickFunction TickFunction;
+
+	void UpdateMovingSlot(int32 Index);
+
+	void UpdateSignificance(float Now);
+
+	/** Fills DuePhases and DueLocations for DueIndices in NumChunks chunks. Reads only the state arrays, so chunks run on any thread. */
+	void ComputeDueLocations(float Now, int32 NumChunks);
+
+	/** Moves a platform that has stopped to its anchor, which it may not have reached if it was updated at an interval. */
+	void SnapToAnchor(int32 Index);
+
+	void SetMoving(int32 Index, bool bMoving);
+
+	float EvaluatePhase(int32 Index, float Time) const;
+
+	FVector EvaluateLocation(int32 Index, float Phase) const;
+};
@@ -0,0 +1,287 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "PlatformBenchmark.h"
+#include "PlatformPath.h"
+#include "TriggerSpatialHash.h"
+#include "TriggerSubsystem.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "Components/BoxComponent.h"
+#include "Components/CapsuleComponent.h"
+#include "Math/RandomStream.h"
+#include "HAL/PlatformTime.h"
+
+const static float TRIGGER_BENCHMARK_SPACING = 400.f;
+const static FVector TRIGGER_BENCHMARK_EXTENT(100.f, 100.f, 50.f);
+const static float TRIGGER_BENCHMARK_PAWN_SPEED = 600.f;
+const static float TRIGGER_BENCHMARK_FRAME_TIME = 1.f / 30.f;
+
+void FPlatformBenchmark::RunPathBenchmark(int32 NumPaths, int32 NumEvaluations) {
+
+	NumPaths = FMath::Max(1, NumPaths);
+
+	NumEvaluations = FMath::Max(1, NumEvaluations);
+
+	FRandomStream Random(NumPaths);
+
+	TArray<FVector> Directions;
+
+	TArray<float> Lengths;
+
+	TArray<FPlatformPath> Paths;
+
+	Directions.Reserve(NumPaths);
+
+	Lengths.Reserve(NumPaths);
+
+	Paths.SetNum(NumPaths);
+
+	const double BakeStart = FPlatformTime::Seconds();
+
+	for (int32 i = 0; i < NumPaths; i++) {
+
+		TArray<FVector> Points;
+
+		Points.Add(FVector::ZeroVector);
+
+		for (int32 Point = 0; Point < 4; Point++) {
+
+			Points.Add(Points.Last() + Random.GetUnitVector() * Random.FRandRange(200.f, 800.f));
+		}
+
+		Paths[i].Bake(Points, 10.f);
+
+		Directions.Add((Points.Last() - Points[0]).GetSafeNormal());
+
+		Lengths.Add(Paths[i].Length);
+	}
+
+	const double BakeSeconds = FPlatformTime::Seconds() - BakeStart;
+
+	// Accumulate results so the evaluations can't be optimized away.
+	FVector Checksum = FVector::ZeroVector;
+
+	const double LinearStart = FPlatformTime::Seconds();
+
+	for (int32 Evaluation = 0; Evaluation < NumEvaluations; Evaluation++) {
+
+		const float Alpha = float(Evaluation) / NumEvaluations;
+
+		for (int32 i = 0; i < NumPaths; i++) {
+
+			Checksum += Directions[i] * (Alpha * Lengths[i]);
+		}
+	}
+
+	const double LinearSeconds = FPlatformTime::Seconds() - LinearStart;
+
+	const double SplineStart = FPlatformTime::Seconds();
+
+	for (int32 Evaluation = 0; Evaluation < NumEvaluations; Evaluation++) {
+
+		const float Alpha = float(Evaluation) / NumEvaluations;
+
+		for (int32 i = 0; i < NumPaths; i++) {
+
+			Checksum += Paths[i].Evaluate(Alpha * Lengths[i]);
+		}
+	}
+
+	const double SplineSeconds = FPlatformTime::Seconds() - SplineStart;
+
+	const double NumTotal = double(NumPaths) * NumEvaluations;
+
+	UE_LOG(LogTemp, Warning, TEXT("Path benchmark: %d paths x %d evaluations (checksum %s)"), NumPaths, NumEvaluations, *Checksum.ToString());
+	UE_LOG(LogTemp, Warning, TEXT("  Spline bake:  %.3f ms total, %.3f us per path"), BakeSeconds * 1000.0, BakeSeconds * 1e6 / NumPaths);
+	UE_LOG(LogTemp, Warning, TEXT("  Linear path:  %.3f ms total, %.2f ns per evaluation"), LinearSeconds * 1000.0, LinearSeconds * 1e9 / NumTotal);
+	UE_LOG(LogTemp, Warning, TEXT("  Spline table: %.3f ms total, %.2f ns per evaluation"), SplineSeconds * 1000.0, SplineSeconds * 1e9 / NumTotal);
+}
+
+void FPlatformBenchmark::RunTriggerBenchmark(UWorld* World, int32 NumPawns, int32 NumFrames) {
+
+	if (!ensure(World != nullptr)) return;
+
+	NumPawns = FMath::Max(1, NumPawns);
+
+	NumFrames = FMath::Max(1, NumFrames);
+
+	const int32 TriggerCounts[] = { 1000, 10000, 50000 };
+
+	UE_LOG(LogTemp, Warning, TEXT("Trigger benchmark: %d pawns x %d frames per run"), NumPawns, NumFrames);
+
+	for (const int32 NumTriggers : TriggerCounts) {
+
+		const int32 Columns = FMath::CeilToInt(FMath::Sqrt(float(NumTriggers)));
+
+		const float GridSize = Columns * TRIGGER_BENCHMARK_SPACING;
+
+		// Far below the playable space, so the benchmark geometry does not touch the level.
+		const FVector Origin(0.f, 0.f, -100000.f);
+
+		TArray<FBox> Volumes;
+
+		Volumes.Reserve(NumTriggers);
+
+		for (int32 i = 0; i < NumTriggers; i++) {
+
+			const FVector Center = Origin + FVector(TRIGGER_BENCHMARK_SPACING * (i % Columns), TRIGGER_BENCHMARK_SPACING * (i / Columns), 0.f);
+
+			Volumes.Add(FBox(Center - TRIGGER_BENCHMARK_EXTENT, Center + TRIGGER_BENCHMARK_EXTENT));
+		}
+
+		// Both paths replay the same random walks.
+		TArray<FVector> PawnPaths;
+
+		PawnPaths.SetNum(NumPawns * NumFrames);
+
+		FRandomStream Random(NumTriggers);
+
+		for (int32 Pawn = 0; Pawn < NumPawns; Pawn++) {
+
+			FVector Location = Origin + FVector(Random.FRandRange(0.f, GridSize), Random.FRandRange(0.f, GridSize), 0.f);
+
+			FVector Direction = Random.GetUnitVector().GetSafeNormal2D();
+
+			for (int32 Frame = 0; Frame < NumFrames; Frame++) {
+
+				if (Frame % 30 == 0) {
+
+					Direction = Random.GetUnitVector().GetSafeNormal2D();
+				}
+
+				Location += Direction * TRIGGER_BENCHMARK_PAWN_SPEED * TRIGGER_BENCHMARK_FRAME_TIME;
+
+				Location.X = FMath::Clamp(Location.X, Origin.X, Origin.X + GridSize);
+
+				Location.Y = FMath::Clamp(Location.Y, Origin.Y, Origin.Y + GridSize);
+
+				PawnPaths[Pawn * NumFrames + Frame] = Location;
+			}
+		}
+
+		FActorSpawnParameters SpawnParams;
+
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+		SpawnParams.ObjectFlags |= RF_Transient;
+
+		AActor* TriggerActor = World->SpawnActor<AActor>(AActor::StaticClass(), FTransform(Origin), SpawnParams);
+
+		AActor* PawnActor = World->SpawnActor<AActor>(AActor::StaticClass(), FTransform(Origin), SpawnParams);
+
+		if (TriggerActor == nullptr || PawnActor == nullptr) return;
+
+		const double SetupStart = FPlatformTime::Seconds();
+
+		for (const FBox& Volume : Volumes) {
+
+			UBoxComponent* Box = NewObject<UBoxComponent>(TriggerActor);
+
+			Box->SetCollisionProfileName(TEXT("Trigger"));
+
+			Box->SetGenerateOverlapEvents(true);
+
+			Box->SetBoxExtent(TRIGGER_BENCHMARK_EXTENT, false);
+
+			Box->SetWorldLocation(Volume.GetCenter());
+
+			Box->RegisterComponent();
+		}
+
+		const double OverlapSetupSeconds = FPlatformTime::Seconds() - SetupStart;
+
+		TArray<UCapsuleComponent*> Capsules;
+
+		for (int32 Pawn = 0; Pawn < NumPawns; Pawn++) {
+
+			UCapsuleComponent* Capsule = NewObject<UCapsuleComponent>(PawnActor);
+
+			Capsule->InitCapsuleSize(42.f, 96.f);
+
+			Capsule->SetCollisionProfileName(TEXT("Pawn"));
+
+			Capsule->SetGenerateOverlapEvents(true);
+
+			Capsule->SetWorldLocation(PawnPaths[Pawn * NumFrames]);
+
+			Capsule->RegisterComponent();
+
+			Capsules.Add(Capsule);
+		}
+
+		int64 OverlapChecksum = 0;
+
+		const double OverlapStart = FPlatformTime::Seconds();
+
+		for (int32 Frame = 0; Frame < NumFrames; Frame++) {
+
+			for (int32 Pawn = 0; Pawn < NumPawns; Pawn++) {
+
+				Capsules[Pawn]->SetWorldLocation(PawnPaths[Pawn * NumFrames + Frame]);
+
+				OverlapChecksum += Capsules[Pawn]->GetOverlapInfos().Num();
+			}
+		}
+
+		const double OverlapSeconds = FPlatformTime::Seconds() - OverlapStart;
+
+		TriggerActor->Destroy();
+
+		PawnActor->Destroy();
+
+		const double HashSetupStart = FPlatformTime::Seconds();
+
+		FTriggerSpatialHash Hash(GetDefault<UTriggerSubsystem>()->GetCellSize());
+
+		for (const FBox& Volume : Volumes) {
+
+			Hash.Add(Volume);
+		}
+
+		const double HashSetupSeconds = FPlatformTime::Seconds() - HashSetupStart;
+
+		const FVector PawnExtent(42.f, 42.f, 96.f);
+
+		TArray<int32> Results;
+
+		TArray<TArray<int32>> PawnResults;
+
+		PawnResults.SetNum(NumPawns);
+
+		int64 HashChecksum = 0;
+
+		int64 HashEvents = 0;
+
+		// Times the same work UTriggerSubsystem::Tick does per pawn: query, sort, and the merge that dispatches entered and left triggers.
+		const double HashStart = FPlatformTime::Seconds();
+
+		for (int32 Frame = 0; Frame < NumFrames; Frame++) {
+
+			for (int32 Pawn = 0; Pawn < NumPawns; Pawn++) {
+
+				const FVector& Location = PawnPaths[Pawn * NumFrames + Frame];
+
+				Results.Reset();
+
+				Hash.Query(FBox(Location - PawnExtent, Location + PawnExtent), Results);
+
+				Results.Sort();
+
+				TArray<int32>& Previous = PawnResults[Pawn];
+
+				FTriggerSpatialHash::DiffSorted(Previous, Results, [&HashEvents](int32) { HashEvents++; }, [&HashEvents](int32) { HashEvents++; });
+
+				Previous = Results;
+
+				HashChecksum += Results.Num();
+			}
+		}
+
+		const double HashSeconds = FPlatformTime::Seconds() - HashStart;
+
+		UE_LOG(LogTemp, Warning, TEXT("  %d triggers (%d cells of %.0f):"), NumTriggers, Hash.GetNumCells(), GetDefault<UTriggerSubsystem>()->GetCellSize());
+		UE_LOG(LogTemp, Warning, TEXT("    Overlap components: %.3f ms per frame, setup %.1f ms, %lld overlaps"), OverlapSeconds * 1000.0 / NumFrames, OverlapSetupSeconds * 1000.0, OverlapChecksum);
+		UE_LOG(LogTemp, Warning, TEXT("    Spatial hash:       %.3f ms per frame, setup %.1f ms, %lld overlaps, %lld enter/leave events"), HashSeconds * 1000.0 / NumFrames, HashSetupSeconds * 1000.0, HashChecksum, HashEvents);
+	}
+}
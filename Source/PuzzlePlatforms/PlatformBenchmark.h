@@ -0,0 +1,22 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Synthetic micro-benchmarks for the platform simulation, run through the game instance exec commands.
+ */
+class PUZZLEPLATFORMS_API FPlatformBenchmark {
+
+public:
+
+	/** Evaluates NumPaths straight-line and baked spline paths NumEvaluations times each and logs the cost per evaluation. */
+	static void RunPathBenchmark(int32 NumPaths, int32 NumEvaluations);
+
+	/**
+	 * Moves NumPawns capsules over grids of 1k, 10k and 50k trigger boxes for NumFrames frames each, once through
+	 * component overlap updates and once through FTriggerSpatialHash queries, and logs the cost per frame of each.
+	 */
+	static void RunTriggerBenchmark(UWorld* World, int32 NumPawns, int32 NumFrames);
+};
@@ -0,0 +1,127 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/NetSerialization.h"
+#include "PlatformMotion.generated.h"
+
+/**
+ * Everything a client needs to reproduce a platform's ping-pong motion locally.
+ * The path and speed replicate once; the anchor travels separately as a compact FPlatformNetState.
+ */
+USTRUCT()
+struct FPlatformMotion {
+
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FVector_NetQuantize StartLocation = FVector::ZeroVector;
+
+	UPROPERTY()
+	FVector_NetQuantize TargetLocation = FVector::ZeroVector;
+
+	UPROPERTY()
+	float Speed = 0.f;
+
+	/** Distance along the start -> target -> start cycle at TimeAnchor. */
+	UPROPERTY(NotReplicated)
+	float PhaseAnchor = 0.f;
+
+	/** Server world time the anchor was taken at. */
+	UPROPERTY(NotReplicated)
+	float TimeAnchor = 0.f;
+
+	UPROPERTY(NotReplicated)
+	bool bMoving = false;
+
+	static FORCEINLINE float EvaluatePhase(float PhaseAnchor, float TimeAnchor, float Speed, bool bMoving, float CycleLength, float Time) {
+
+		if (!bMoving || CycleLength <= KINDA_SMALL_NUMBER) return PhaseAnchor;
+
+		float Phase = FMath::Fmod(PhaseAnchor + Speed * (Time - TimeAnchor), CycleLength);
+
+		return Phase < 0.f ? Phase + CycleLength : Phase;
+	}
+
+	static FORCEINLINE float PhaseToJourneyTravel(float Phase, float JourneyLength) {
+
+		return Phase <= JourneyLength ? Phase : 2.f * JourneyLength - Phase;
+	}
+};
+
+/**
+ * Replicated anchor of a platform's motion: where along its path it is, which way it is heading, whether it is
+ * moving and the server time of the sample. Positions are carried as a fraction of the journey, so the state is
+ * 50 bits whatever the size of the map.
+ */
+USTRUCT()
+struct FPlatformNetState {
+
+	GENERATED_BODY()
+
+	/** Travel along the journey, 0 at the start location and MAX_uint16 at the target. */
+	uint16 Alpha = 0;
+
+	/** Heading back from the target towards the start. */
+	bool bReturning = false;
+
+	bool bActive = false;
+
+	/** Server world time the sample was taken at. */
+	float Timestamp = 0.f;
+
+	static FPlatformNetState FromPhase(float Phase, float JourneyLength, bool bActive, float Timestamp) {
+
+		FPlatformNetState State;
+
+		const float Travel = FPlatformMotion::PhaseToJourneyTravel(Phase, JourneyLength);
+
+		State.Alpha = JourneyLength > KINDA_SMALL_NUMBER ? (uint16)FMath::RoundToInt(FMath::Clamp(Travel / JourneyLength, 0.f, 1.f) * MAX_uint16) : 0;
+		State.bReturning = Phase > JourneyLength;
+		State.bActive = bActive;
+		State.Timestamp = Timestamp;
+
+		return State;
+	}
+
+	float ToPhase(float JourneyLength) const {
+
+		const float Travel = (float)Alpha / MAX_uint16 * JourneyLength;
+
+		return bReturning ? 2.f * JourneyLength - Travel : Travel;
+	}
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess) {
+
+		Ar << Alpha;
+
+		uint8 Flags = (bReturning ? 1 : 0) | (bActive ? 2 : 0);
+
+		Ar.SerializeBits(&Flags, 2);
+
+		bReturning = (Flags & 1) != 0;
+		bActive = (Flags & 2) != 0;
+
+		Ar << Timestamp;
+
+		bOutSuccess = true;
+
+		return true;
+	}
+
+	bool operator==(const FPlatformNetState& Other) const {
+
+		return Alpha == Other.Alpha && bReturning == Other.bReturning && bActive == Other.bActive && Timestamp == Other.Timestamp;
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FPlatformNetState> : public TStructOpsTypeTraitsBase2<FPlatformNetState> {
+
+	enum {
+		WithNetSerializer = true,
+		// The fields are not UPROPERTYs, so change detection has to go through operator==.
+		WithIdenticalViaEquality = true
+	};
+};
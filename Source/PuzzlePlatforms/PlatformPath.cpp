@@ -0,0 +1,77 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "PlatformPath.h"
+#include "Math/InterpCurve.h"
+
+static const int32 PATH_BAKE_SUBSTEPS = 64;
+
+void FPlatformPath::Bake(const TArray<FVector>& Points, float InSampleSpacing) {
+
+	Samples.Reset();
+
+	SampleSpacing = 0.f;
+
+	Length = 0.f;
+
+	if (Points.Num() < 2 || InSampleSpacing <= KINDA_SMALL_NUMBER) return;
+
+	FInterpCurveVector Curve;
+
+	for (int32 i = 0; i < Points.Num(); i++) {
+
+		const int32 PointIndex = Curve.AddPoint(i, Points[i]);
+
+		Curve.Points[PointIndex].InterpMode = CIM_CurveAuto;
+	}
+
+	Curve.AutoSetTangents();
+
+	// Walk the curve densely once to measure it, then resample it at equal arc-length steps.
+	const int32 NumDense = (Points.Num() - 1) * PATH_BAKE_SUBSTEPS + 1;
+
+	TArray<FVector> DensePoints;
+
+	TArray<float> DenseDistances;
+
+	DensePoints.Reserve(NumDense);
+
+	DenseDistances.Reserve(NumDense);
+
+	for (int32 i = 0; i < NumDense; i++) {
+
+		const FVector Point = Curve.Eval(float(i) / PATH_BAKE_SUBSTEPS);
+
+		Length += i > 0 ? FVector::Dist(DensePoints.Last(), Point) : 0.f;
+
+		DensePoints.Add(Point);
+
+		DenseDistances.Add(Length);
+	}
+
+	if (Length <= KINDA_SMALL_NUMBER) return;
+
+	const int32 NumSamples = FMath::Max(2, FMath::CeilToInt(Length / InSampleSpacing) + 1);
+
+	SampleSpacing = Length / (NumSamples - 1);
+
+	Samples.Reserve(NumSamples);
+
+	int32 Segment = 0;
+
+	for (int32 i = 0; i < NumSamples; i++) {
+
+		const float Distance = FMath::Min(i * SampleSpacing, Length);
+
+		while (Segment < NumDense - 2 && DenseDistances[Segment + 1] < Distance) {
+
+			Segment++;
+		}
+
+		const float SegmentLength = DenseDistances[Segment + 1] - DenseDistances[Segment];
+
+		const float Alpha = SegmentLength > KINDA_SMALL_NUMBER ? (Distance - DenseDistances[Segment]) / SegmentLength : 0.f;
+
+		Samples.Add(FMath::Lerp(DensePoints[Segment], DensePoints[Segment + 1], FMath::Clamp(Alpha, 0.f, 1.f)));
+	}
+}
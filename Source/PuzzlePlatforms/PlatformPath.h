@@ -0,0 +1,68 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PlatformPath.generated.h"
+
+UENUM()
+enum class EPlatformPathMode : uint8 {
+
+	/** Straight line from the platform to TargetLocation. */
+	Linear,
+
+	/** Smooth curve from the platform through Waypoints to TargetLocation. */
+	Spline
+};
+
+UENUM()
+enum class EPlatformEasing : uint8 {
+
+	Linear,
+
+	EaseInOut,
+
+	Sinusoidal
+};
+
+/**
+ * A platform path baked into points spaced evenly by arc length, relative to the path start.
+ * Evaluating a distance along the path is a constant-time lookup and lerp.
+ */
+struct PUZZLEPLATFORMS_API FPlatformPath {
+
+	TArray<FVector> Samples;
+
+	float SampleSpacing = 0.f;
+
+	float Length = 0.f;
+
+	bool IsBaked() const { return Samples.Num() >= 2; }
+
+	/** Bakes a curve passing through Points (the first one being the path start) at roughly InSampleSpacing resolution. */
+	void Bake(const TArray<FVector>& Points, float InSampleSpacing);
+
+	FORCEINLINE FVector Evaluate(float Distance) const {
+
+		const float Position = FMath::Clamp(Distance / SampleSpacing, 0.f, float(Samples.Num() - 1));
+
+		const int32 Index = FMath::Min(FMath::FloorToInt(Position), Samples.Num() - 2);
+
+		return FMath::Lerp(Samples[Index], Samples[Index + 1], Position - Index);
+	}
+
+	static FORCEINLINE float Ease(EPlatformEasing Easing, float Alpha) {
+
+		switch (Easing) {
+
+		case EPlatformEasing::EaseInOut:
+			return FMath::SmoothStep(0.f, 1.f, Alpha);
+
+		case EPlatformEasing::Sinusoidal:
+			return 0.5f - 0.5f * FMath::Cos(PI * Alpha);
+
+		default:
+			return Alpha;
+		}
+	}
+};
@@ -0,0 +1,389 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "PlatformStressTest.h"
+#include "Engine/World.h"
+#include "Engine/NetDriver.h"
+#include "Engine/NetConnection.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerState.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "HAL/PlatformTime.h"
+#include "MovingPlatform.h"
+#include "MovingPlatformSubsystem.h"
+#include "TriggerPlatform.h"
+#include "PuzzlePlatformsCharacter.h"
+#include "PuzzlePlatformsCharacterMovement.h"
+
+static const float STRESS_GRID_SPACING = 400.f;
+
+void UPlatformStressTest::BeginDestroy() {
+
+	if (TickerHandle.IsValid()) {
+
+		FTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+
+		TickerHandle.Reset();
+	}
+
+	Super::BeginDestroy();
+}
+
+void UPlatformStressTest::SpawnGrid(UWorld* World, int32 NumPlatforms, int32 NumTriggers) {
+
+	if (!ensure(World != nullptr)) return;
+
+	if (World->GetNetMode() == NM_Client) {
+
+		UE_LOG(LogTemp, Warning, TEXT("Stress grid can only be spawned on the server."));
+		return;
+	}
+
+	const int32 PlatformColumns = FMath::Max(1, FMath::CeilToInt(FMath::Sqrt(float(NumPlatforms))));
+
+	FActorSpawnParameters SpawnParams;
+
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	for (int32 i = 0; i < NumPlatforms; i++) {
+
+		const FVector Location(STRESS_GRID_SPACING * (i % PlatformColumns), STRESS_GRID_SPACING * (i / PlatformColumns), 0.f);
+
+		AMovingPlatform* Platform = World->SpawnActorDeferred<AMovingPlatform>(AMovingPlatform::StaticClass(), FTransform(Location), nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+
+		if (Platform == nullptr) continue;
+
+		Platform->Speed = 50.f + 10.f * (i % 16);
+
+		Platform->TargetLocation = FVector(0.f, 0.f, 300.f);
+
+		Platform->FinishSpawning(FTransform(Location));
+
+		Platforms.Add(Platform);
+	}
+
+	const int32 TriggerColumns = FMath::Max(1, FMath::CeilToInt(FMath::Sqrt(float(NumTriggers))));
+
+	const float TriggerOffset = -STRESS_GRID_SPACING * (TriggerColumns + 1);
+
+	for (int32 i = 0; i < NumTriggers; i++) {
+
+		const FVector Location(TriggerOffset + STRESS_GRID_SPACING * (i % TriggerColumns), STRESS_GRID_SPACING * (i / TriggerColumns), 0.f);
+
+		ATriggerPlatform* Trigger = World->SpawnActor<ATriggerPlatform>(ATriggerPlatform::StaticClass(), Location, FRotator::ZeroRotator, SpawnParams);
+
+		if (Trigger == nullptr) continue;
+
+		Triggers.Add(Trigger);
+
+		TriggerStates.Add(false);
+	}
+
+	// Spread the platforms evenly over the triggers.
+	for (int32 i = 0; i < Platforms.Num() && Triggers.Num() > 0; i++) {
+
+		Triggers[i % Triggers.Num()]->AddPlatformToTrigger(Platforms[i]);
+	}
+
+	UE_LOG(LogTemp, Warning, TEXT("Stress grid: %d platforms, %d triggers."), Platforms.Num(), Triggers.Num());
+}
+
+void UPlatformStressTest::Clear() {
+
+	DriveOverlaps(0.f);
+
+	for (ATriggerPlatform* Trigger : Triggers) {
+
+		if (IsValid(Trigger)) {
+
+			Trigger->Destroy();
+		}
+	}
+
+	for (AMovingPlatform* Platform : Platforms) {
+
+		if (IsValid(Platform)) {
+
+			Platform->Destroy();
+		}
+	}
+
+	Triggers.Empty();
+
+	TriggerStates.Empty();
+
+	Platforms.Empty();
+}
+
+void UPlatformStressTest::DriveOverlaps(float Interval) {
+
+	OverlapInterval = FMath::Max(0.f, Interval);
+
+	OverlapTimer = 0.f;
+
+	if (OverlapInterval <= 0.f) {
+
+		// Leave every trigger released so the platforms go back to sleep.
+		for (int32 i = 0; i < Triggers.Num(); i++) {
+
+			if (TriggerStates[i] && IsValid(Triggers[i])) {
+
+				Triggers[i]->DeactivatePlatforms();
+			}
+
+			TriggerStates[i] = false;
+		}
+	}
+
+	UpdateTicker();
+}
+
+void UPlatformStressTest::Record(UWorld* World, float Seconds, const FString& Label) {
+
+	if (!ensure(World != nullptr)) return;
+
+	RecordWorld = World;
+
+	RecordTimeRemaining = FMath::Max(Seconds, 0.1f);
+
+	RecordLabel = Label.IsEmpty() ? TEXT("Default") : Label;
+
+	UNetDriver* NetDriver = World->GetNetDriver();
+
+	LastOutTotalBytes = NetDriver != nullptr ? NetDriver->OutTotalBytes : 0;
+
+	LastTotalCorrections = UPuzzlePlatformsCharacterMovement::GetTotalCorrectionsSent();
+
+	Samples.Reset();
+
+	ConnectionSamples.Reset();
+
+	UE_LOG(LogTemp, Warning, TEXT("Stress recording '%s' for %.1f seconds."), *RecordLabel, RecordTimeRemaining);
+
+	UpdateTicker();
+}
+
+void UPlatformStressTest::UpdateTicker() {
+
+	const bool bNeedsTicker = OverlapInterval > 0.f || RecordTimeRemaining > 0.f;
+
+	if (bNeedsTicker && !TickerHandle.IsValid()) {
+
+		TickerHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &UPlatformStressTest::Tick));
+	}
+	else if (!bNeedsTicker && TickerHandle.IsValid()) {
+
+		FTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+
+		TickerHandle.Reset();
+	}
+}
+
+bool UPlatformStressTest::Tick(float DeltaTime) {
+
+	if (OverlapInterval > 0.f) {
+
+		OverlapTimer += DeltaTime;
+
+		if (OverlapTimer >= OverlapInterval) {
+
+			OverlapTimer -= OverlapInterval;
+
+			ToggleTriggers();
+		}
+	}
+
+	UWorld* World = RecordWorld.Get();
+
+	if (RecordTimeRemaining > 0.f && World != nullptr) {
+
+		UNetDriver* NetDriver = World->GetNetDriver();
+
+		const uint32 OutTotalBytes = NetDriver != nullptr ? NetDriver->OutTotalBytes : 0;
+
+		UMovingPlatformSubsystem* PlatformSubsystem = World->GetSubsystem<UMovingPlatformSubsystem>();
+
+		FFrameSample Sample;
+
+		Sample.FrameMs = DeltaTime * 1000.f;
+		Sample.GameThreadMs = FPlatformTime::ToMilliseconds(GGameThreadTime);
+		Sample.MovingPlatforms = PlatformSubsystem != nullptr ? PlatformSubsystem->GetNumMovingPlatforms() : 0;
+		Sample.OutBytes = OutTotalBytes - LastOutTotalBytes;
+		Sample.Connections = NetDriver != nullptr ? NetDriver->ClientConnections.Num() : 0;
+		Sample.Corrections = UPuzzlePlatformsCharacterMovement::GetTotalCorrectionsSent() - LastTotalCorrections;
+
+		Samples.Add(Sample);
+
+		LastOutTotalBytes = OutTotalBytes;
+
+		LastTotalCorrections += Sample.Corrections;
+
+		SampleConnections(NetDriver);
+
+		RecordTimeRemaining -= DeltaTime;
+
+		if (RecordTimeRemaining <= 0.f) {
+
+			WriteResults();
+
+			UpdateTicker();
+		}
+	}
+
+	return true;
+}
+
+void UPlatformStressTest::ToggleTriggers() {
+
+	bOverlapPhase = !bOverlapPhase;
+
+	for (int32 i = 0; i < Triggers.Num(); i++) {
+
+		if (!IsValid(Triggers[i])) continue;
+
+		const bool bShouldBeActive = (i % 2 == 0) == bOverlapPhase;
+
+		if (bShouldBeActive == TriggerStates[i]) continue;
+
+		if (bShouldBeActive) {
+
+			Triggers[i]->ActivatePlatforms();
+		}
+		else {
+
+			Triggers[i]->DeactivatePlatforms();
+		}
+
+		TriggerStates[i] = bShouldBeActive;
+	}
+}
+
+void UPlatformStressTest::SampleConnections(UNetDriver* NetDriver) {
+
+	if (NetDriver == nullptr) return;
+
+	for (UNetConnection* Connection : NetDriver->ClientConnections) {
+
+		if (Connection == nullptr) continue;
+
+		FConnectionSample& ConnectionSample = ConnectionSamples.FindOrAdd(Connection);
+
+		APlayerController* PlayerController = Connection->PlayerController;
+
+		if (ConnectionSample.Name.IsEmpty()) {
+
+			ConnectionSample.Name = PlayerController != nullptr && PlayerController->PlayerState != nullptr ? PlayerController->PlayerState->GetPlayerName() : Connection->LowLevelGetRemoteAddress(true);
+		}
+
+		ConnectionSample.OutBytesPerSecondSum += Connection->OutBytesPerSecond;
+
+		ConnectionSample.InBytesPerSecondSum += Connection->InBytesPerSecond;
+
+		ConnectionSample.NumSamples++;
+
+		APuzzlePlatformsCharacter* Character = PlayerController != nullptr ? Cast<APuzzlePlatformsCharacter>(PlayerController->GetPawn()) : nullptr;
+
+		UPuzzlePlatformsCharacterMovement* Movement = Character != nullptr ? Cast<UPuzzlePlatformsCharacterMovement>(Character->GetCharacterMovement()) : nullptr;
+
+		if (Movement != nullptr) {
+
+			if (ConnectionSample.StartCorrections == INDEX_NONE) {
+
+				ConnectionSample.StartCorrections = Movement->GetNumCorrectionsSent();
+			}
+
+			ConnectionSample.EndCorrections = Movement->GetNumCorrectionsSent();
+		}
+	}
+}
+
+void UPlatformStressTest::WriteResults() {
+
+	RecordTimeRemaining = 0.f;
+
+	if (Samples.Num() == 0) return;
+
+	FString Csv = TEXT("Frame,FrameMs,GameThreadMs,MovingPlatforms,OutBytes,Connections,Corrections\n");
+
+	TArray<float> GameThreadTimes;
+
+	uint64 TotalBytes = 0;
+
+	int64 TotalMovingPlatforms = 0;
+
+	double TotalFrameMs = 0.0;
+
+	double TotalGameThreadMs = 0.0;
+
+	for (int32 i = 0; i < Samples.Num(); i++) {
+
+		const FFrameSample& Sample = Samples[i];
+
+		Csv += FString::Printf(TEXT("%d,%.3f,%.3f,%d,%u,%d,%d\n"), i, Sample.FrameMs, Sample.GameThreadMs, Sample.MovingPlatforms, Sample.OutBytes, Sample.Connections, Sample.Corrections);
+
+		GameThreadTimes.Add(Sample.GameThreadMs);
+
+		TotalBytes += Sample.OutBytes;
+
+		TotalMovingPlatforms += Sample.MovingPlatforms;
+
+		TotalFrameMs += Sample.FrameMs;
+
+		TotalGameThreadMs += Sample.GameThreadMs;
+	}
+
+	GameThreadTimes.Sort();
+
+	const int32 NumSamples = Samples.Num();
+
+	const float AverageGameThreadMs = TotalGameThreadMs / NumSamples;
+
+	const float P95GameThreadMs = GameThreadTimes[FMath::Min(NumSamples - 1, NumSamples * 95 / 100)];
+
+	const double Seconds = TotalFrameMs / 1000.0;
+
+	const FString Timestamp = FDateTime::Now().ToString();
+
+	const FString ProfilingDir = FPaths::ProjectSavedDir() / TEXT("Profiling");
+
+	const FString FramesPath = ProfilingDir / FString::Printf(TEXT("PlatformStress_%s_%s.csv"), *RecordLabel, *Timestamp);
+
+	FFileHelper::SaveStringToFile(Csv, *FramesPath);
+
+	if (ConnectionSamples.Num() > 0) {
+
+		FString ConnectionsCsv = TEXT("Connection,OutBytesPerSecond,InBytesPerSecond,Corrections,CorrectionsPerMinute\n");
+
+		for (const TPair<TWeakObjectPtr<UNetConnection>, FConnectionSample>& Pair : ConnectionSamples) {
+
+			const FConnectionSample& ConnectionSample = Pair.Value;
+
+			const int32 Corrections = ConnectionSample.StartCorrections != INDEX_NONE ? ConnectionSample.EndCorrections - ConnectionSample.StartCorrections : 0;
+
+			ConnectionsCsv += FString::Printf(TEXT("%s,%.1f,%.1f,%d,%.1f\n"), *ConnectionSample.Name,
+				ConnectionSample.OutBytesPerSecondSum / ConnectionSample.NumSamples, ConnectionSample.InBytesPerSecondSum / ConnectionSample.NumSamples,
+				Corrections, Seconds > 0.0 ? Corrections * 60.0 / Seconds : 0.0);
+		}
+
+		FFileHelper::SaveStringToFile(ConnectionsCsv, *(ProfilingDir / FString::Printf(TEXT("PlatformStress_%s_%s_Connections.csv"), *RecordLabel, *Timestamp)));
+	}
+
+	// One line per run, so regressions can be tracked from run to run.
+	const FString SummaryPath = ProfilingDir / TEXT("PlatformStress_Summary.csv");
+
+	FString Summary;
+
+	if (!FPaths::FileExists(SummaryPath)) {
+
+		Summary = TEXT("Timestamp,Label,Platforms,Triggers,Frames,Seconds,AvgGameThreadMs,P95GameThreadMs,AvgMovingPlatforms,OutBytesPerSecond\n");
+	}
+
+	Summary += FString::Printf(TEXT("%s,%s,%d,%d,%d,%.2f,%.3f,%.3f,%.1f,%.1f\n"), *Timestamp, *RecordLabel, Platforms.Num(), Triggers.Num(), NumSamples, Seconds,
+		AverageGameThreadMs, P95GameThreadMs, double(TotalMovingPlatforms) / NumSamples, Seconds > 0.0 ? TotalBytes / Seconds : 0.0);
+
+	FFileHelper::SaveStringToFile(Summary, *SummaryPath, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append);
+
+	UE_LOG(LogTemp, Warning, TEXT("Stress '%s': %d frames, game thread %.3f ms avg / %.3f ms p95, %.1f moving platforms, %.1f bytes/s. Written to %s"),
+		*RecordLabel, NumSamples, AverageGameThreadMs, P95GameThreadMs, double(TotalMovingPlatforms) / NumSamples, Seconds > 0.0 ? TotalBytes / Seconds : 0.0, *FramesPath);
+}
@@ -0,0 +1,104 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/NoExportTypes.h"
+#include "Containers/Ticker.h"
+#include "PlatformStressTest.generated.h"
+
+/**
+ * Headless platform/trigger stress benchmark driven by the Stress* exec commands on UPuzzlePlatformsGameInstance.
+ * Spawns a grid of platforms and triggers, toggles the triggers synthetically and records per-frame cost to a CSV under Saved/Profiling.
+ * Recordings also capture bandwidth and movement corrections per client connection, for runs with bot clients.
+ */
+UCLASS()
+class PUZZLEPLATFORMS_API UPlatformStressTest : public UObject
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void BeginDestroy() override;
+
+	void SpawnGrid(UWorld* World, int32 NumPlatforms, int32 NumTriggers);
+
+	void Clear();
+
+	/** Toggles every trigger each Interval seconds, half of them out of phase. Zero stops driving overlaps. */
+	void DriveOverlaps(float Interval);
+
+	void Record(UWorld* World, float Seconds, const FString& Label);
+
+private:
+
+	struct FFrameSample {
+
+		float FrameMs;
+
+		float GameThreadMs;
+
+		int32 MovingPlatforms;
+
+		uint32 OutBytes;
+
+		int32 Connections;
+
+		int32 Corrections;
+	};
+
+	struct FConnectionSample {
+
+		FString Name;
+
+		double OutBytesPerSecondSum = 0.0;
+
+		double InBytesPerSecondSum = 0.0;
+
+		int32 NumSamples = 0;
+
+		int32 StartCorrections = INDEX_NONE;
+
+		int32 EndCorrections = 0;
+	};
+
+	UPROPERTY()
+	TArray<class AMovingPlatform*> Platforms;
+
+	UPROPERTY()
+	TArray<class ATriggerPlatform*> Triggers;
+
+	TArray<bool> TriggerStates;
+
+	TWeakObjectPtr<UWorld> RecordWorld;
+
+	FDelegateHandle TickerHandle;
+
+	float OverlapInterval = 0.f;
+
+	float OverlapTimer = 0.f;
+
+	bool bOverlapPhase = false;
+
+	float RecordTimeRemaining = 0.f;
+
+	FString RecordLabel;
+
+	uint32 LastOutTotalBytes = 0;
+
+	int32 LastTotalCorrections = 0;
+
+	TMap<TWeakObjectPtr<class UNetConnection>, FConnectionSample> ConnectionSamples;
+
+	TArray<FFrameSample> Samples;
+
+	bool Tick(float DeltaTime);
+
+	void UpdateTicker();
+
+	void ToggleTriggers();
+
+	void SampleConnections(class UNetDriver* NetDriver);
+
+	void WriteResults();
+};
@@ -8,6 +8,12 @@ public class PuzzlePlatforms : ModuleRules
 	{
 		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
 
-		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "HeadMountedDisplay", "UMG", "OnlineSubsystem", "OnlineSubsystemSteam" });
+		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "OnlineSubsystem", "ReplicationGraph", "Sockets", "Networking", "Json" });
+
+		// Dedicated servers have no headset to reset and only host through the NULL subsystem; the menus live in PuzzlePlatformsMenu.
+		if (Target.Type != TargetType.Server)
+		{
+			PublicDependencyModuleNames.AddRange(new string[] { "HeadMountedDisplay", "OnlineSubsystemSteam" });
+		}
 	}
 }
@@ -1,18 +1,22 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "PuzzlePlatformsCharacter.h"
+#if !UE_SERVER
 #include "HeadMountedDisplayFunctionLibrary.h"
+#endif
 #include "Camera/CameraComponent.h"
 #include "Components/CapsuleComponent.h"
 #include "Components/InputComponent.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "GameFramework/Controller.h"
 #include "GameFramework/SpringArmComponent.h"
+#include "PuzzlePlatformsCharacterMovement.h"
 
 //////////////////////////////////////////////////////////////////////////
 // APuzzlePlatformsCharacter
 
-APuzzlePlatformsCharacter::APuzzlePlatformsCharacter()
+APuzzlePlatformsCharacter::APuzzlePlatformsCharacter(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<UPuzzlePlatformsCharacterMovement>(ACharacter::CharacterMovementComponentName))
 {
 	// Set size for collision capsule
 	GetCapsuleComponent()->InitCapsuleSize(42.f, 96.0f);
@@ -85,7 +89,9 @@ void APuzzlePlatformsCharacter::OnResetVR()
 	//		Add "HeadMountedDisplay" to [YourProject].Build.cs PublicDependencyModuleNames in order to build successfully (appropriate if supporting VR).
 	// or:
 	//		Comment or delete the call to ResetOrientationAndPosition below (appropriate if not supporting VR)
+#if !UE_SERVER
 	UHeadMountedDisplayFunctionLibrary::ResetOrientationAndPosition();
+#endif
 }
 
 void APuzzlePlatformsCharacter::TouchStarted(ETouchIndex::Type FingerIndex, FVector Location)
@@ -110,6 +116,21 @@ void APuzzlePlatformsCharacter::LookUpAtRate(float Rate)
 	AddControllerPitchInput(Rate * BaseLookUpRate * GetWorld()->GetDeltaSeconds());
 }
 
+void APuzzlePlatformsCharacter::ApplyBotInput(float ForwardValue, float RightValue, bool bJump)
+{
+	MoveForward(ForwardValue);
+	MoveRight(RightValue);
+
+	if (bJump)
+	{
+		Jump();
+	}
+	else
+	{
+		StopJumping();
+	}
+}
+
 void APuzzlePlatformsCharacter::MoveForward(float Value)
 {
 	if ((Controller != nullptr) && (Value != 0.0f))
@@ -19,7 +19,7 @@ class APuzzlePlatformsCharacter : public ACharacter
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"))
 	class UCameraComponent* FollowCamera;
 public:
-	APuzzlePlatformsCharacter();
+	APuzzlePlatformsCharacter(const FObjectInitializer& ObjectInitializer);
 
 	/** Base turn rate, in deg/sec. Other scaling may affect final turn rate. */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category=Camera)
@@ -29,6 +29,9 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category=Camera)
 	float BaseLookUpRate;
 
+	/** Drives the character the same way MoveForward, MoveRight and Jump input would. Used by bot clients. */
+	void ApplyBotInput(float ForwardValue, float RightValue, bool bJump);
+
 protected:
 
 	/** Resets HMD orientation in VR. */
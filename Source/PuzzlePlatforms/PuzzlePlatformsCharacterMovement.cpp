@@ -0,0 +1,118 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "PuzzlePlatformsCharacterMovement.h"
+#include "PuzzlePlatforms.h"
+#include "MovingPlatform.h"
+#include "MovingPlatformSubsystem.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Movement Corrections Per Minute"), STAT_CorrectionsPerMinute, STATGROUP_PuzzlePlatforms);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Platform Movement Corrections"), STAT_PlatformCorrections, STATGROUP_PuzzlePlatforms);
+
+const static double CORRECTION_WINDOW_SECONDS = 60.0;
+
+int32 UPuzzlePlatformsCharacterMovement::TotalCorrectionsSent = 0;
+
+int32 UPuzzlePlatformsCharacterMovement::TotalPlatformCorrectionsSent = 0;
+
+TArray<double> UPuzzlePlatformsCharacterMovement::RecentCorrectionTimes;
+
+uint64 UPuzzlePlatformsCharacterMovement::LastCorrectionWindowFrame = 0;
+
+void UPuzzlePlatformsCharacterMovement::BeginPlay() {
+
+	Super::BeginPlay();
+
+	UWorld* World = GetWorld();
+
+	UMovingPlatformSubsystem* PlatformSubsystem = World != nullptr ? World->GetSubsystem<UMovingPlatformSubsystem>() : nullptr;
+
+	// Platforms move first, so based movement and the moves sent to the server use this frame's platform positions.
+	if (PlatformSubsystem != nullptr) {
+
+		PrimaryComponentTick.AddPrerequisite(PlatformSubsystem, PlatformSubsystem->GetTickFunction());
+	}
+}
+
+void UPuzzlePlatformsCharacterMovement::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) {
+
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	if (GetOwnerRole() == ROLE_Authority && LastCorrectionWindowFrame != GFrameCounter) {
+
+		LastCorrectionWindowFrame = GFrameCounter;
+
+		UpdateCorrectionWindow();
+	}
+}
+
+void UPuzzlePlatformsCharacterMovement::ServerSendMoveResponse(const FClientAdjustment& PendingAdjustment) {
+
+	// Only called once SendClientAdjustment has passed its rate limits, so every call here is a response that goes out.
+	if (!PendingAdjustment.bAckGoodMove) {
+
+		NumCorrectionsSent++;
+
+		TotalCorrectionsSent++;
+
+		RecentCorrectionTimes.Add(FPlatformTime::Seconds());
+
+		UpdateCorrectionWindow();
+
+		if (PendingAdjustment.NewBase != nullptr && Cast<AMovingPlatform>(PendingAdjustment.NewBase->GetOwner()) != nullptr) {
+
+			TotalPlatformCorrectionsSent++;
+
+			INC_DWORD_STAT(STAT_PlatformCorrections);
+		}
+	}
+
+	Super::ServerSendMoveResponse(PendingAdjustment);
+}
+
+bool UPuzzlePlatformsCharacterMovement::ServerCheckClientError(float ClientTimeStamp, float DeltaTime, const FVector& Accel, const FVector& ClientWorldLocation, const FVector& RelativeClientLocation, UPrimitiveComponent* ClientMovementBase, FName ClientBaseBoneName, uint8 ClientMovementMode) {
+
+	if (!Super::ServerCheckClientError(ClientTimeStamp, DeltaTime, Accel, ClientWorldLocation, RelativeClientLocation, ClientMovementBase, ClientBaseBoneName, ClientMovementMode)) return false;
+
+	return !IsWithinMovingPlatformTolerance(ClientWorldLocation, ClientMovementBase, ClientMovementMode);
+}
+
+bool UPuzzlePlatformsCharacterMovement::ServerShouldUseAuthoritativePosition(float ClientTimeStamp, float DeltaTime, const FVector& Accel, const FVector& ClientWorldLocation, const FVector& RelativeClientLocation, UPrimitiveComponent* ClientMovementBase, FName ClientBaseBoneName, uint8 ClientMovementMode) {
+
+	// Taking the client's position keeps a small platform disagreement from growing into a correction later.
+	return IsWithinMovingPlatformTolerance(ClientWorldLocation, ClientMovementBase, ClientMovementMode)
+		|| Super::ServerShouldUseAuthoritativePosition(ClientTimeStamp, DeltaTime, Accel, ClientWorldLocation, RelativeClientLocation, ClientMovementBase, ClientBaseBoneName, ClientMovementMode);
+}
+
+bool UPuzzlePlatformsCharacterMovement::IsWithinMovingPlatformTolerance(const FVector& ClientWorldLocation, UPrimitiveComponent* ClientMovementBase, uint8 ClientMovementMode) const {
+
+	if (MovingPlatformErrorTolerance <= 0.f) return false;
+
+	if (ClientMovementBase == nullptr || ClientMovementBase != GetMovementBase()) return false;
+
+	if (Cast<AMovingPlatform>(ClientMovementBase->GetOwner()) == nullptr) return false;
+
+	if (ClientMovementMode != PackNetworkMovementMode()) return false;
+
+	// The client location was rebuilt from the server's platform position, so this is the error relative to the platform.
+	return FVector::DistSquared(UpdatedComponent->GetComponentLocation(), ClientWorldLocation) <= FMath::Square(MovingPlatformErrorTolerance);
+}
+
+void UPuzzlePlatformsCharacterMovement::UpdateCorrectionWindow() {
+
+	const double WindowStart = FPlatformTime::Seconds() - CORRECTION_WINDOW_SECONDS;
+
+	int32 NumExpired = 0;
+
+	while (NumExpired < RecentCorrectionTimes.Num() && RecentCorrectionTimes[NumExpired] < WindowStart) {
+
+		NumExpired++;
+	}
+
+	if (NumExpired > 0) {
+
+		RecentCorrectionTimes.RemoveAt(0, NumExpired, false);
+	}
+
+	SET_DWORD_STAT(STAT_CorrectionsPerMinute, RecentCorrectionTimes.Num());
+}
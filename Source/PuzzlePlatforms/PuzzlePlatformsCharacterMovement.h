@@ -0,0 +1,62 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "PuzzlePlatformsCharacterMovement.generated.h"
+
+/**
+ * Character movement that counts the position corrections the server sends to its client.
+ * Moves based on an AMovingPlatform are checked relative to the platform, which both sides evaluate from the same
+ * replicated motion. Small disagreements there can optionally be settled in the client's favour instead of corrected.
+ */
+UCLASS()
+class PUZZLEPLATFORMS_API UPuzzlePlatformsCharacterMovement : public UCharacterMovementComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void BeginPlay() override;
+
+	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	virtual void ServerSendMoveResponse(const FClientAdjustment& PendingAdjustment) override;
+
+	virtual bool ServerCheckClientError(float ClientTimeStamp, float DeltaTime, const FVector& Accel, const FVector& ClientWorldLocation, const FVector& RelativeClientLocation, UPrimitiveComponent* ClientMovementBase, FName ClientBaseBoneName, uint8 ClientMovementMode) override;
+
+	virtual bool ServerShouldUseAuthoritativePosition(float ClientTimeStamp, float DeltaTime, const FVector& Accel, const FVector& ClientWorldLocation, const FVector& RelativeClientLocation, UPrimitiveComponent* ClientMovementBase, FName ClientBaseBoneName, uint8 ClientMovementMode) override;
+
+	/** Largest client error, in cm, accepted without a correction while standing on a moving platform. 0 disables it, since accepted errors no longer show up as corrections. */
+	UPROPERTY(EditDefaultsOnly, Category = "Character Movement (Networking)", Meta = (ClampMin = 0))
+	float MovingPlatformErrorTolerance = 0.f;
+
+	int32 GetNumCorrectionsSent() const { return NumCorrectionsSent; }
+
+	/** Corrections sent by every character on this server since startup. */
+	static int32 GetTotalCorrectionsSent() { return TotalCorrectionsSent; }
+
+	/** Corrections sent while the character stood on a moving platform, by every character on this server since startup. */
+	static int32 GetTotalPlatformCorrectionsSent() { return TotalPlatformCorrectionsSent; }
+
+	/** Corrections sent by every character on this server over the last minute. */
+	static int32 GetCorrectionsPerMinute() { return RecentCorrectionTimes.Num(); }
+
+private:
+
+	int32 NumCorrectionsSent = 0;
+
+	static int32 TotalCorrectionsSent;
+
+	static int32 TotalPlatformCorrectionsSent;
+
+	/** Times of the corrections sent in the last minute, oldest first. */
+	static TArray<double> RecentCorrectionTimes;
+
+	static uint64 LastCorrectionWindowFrame;
+
+	static void UpdateCorrectionWindow();
+
+	bool IsWithinMovingPlatformTolerance(const FVector& ClientWorldLocation, UPrimitiveComponent* ClientMovementBase, uint8 ClientMovementMode) const;
+};
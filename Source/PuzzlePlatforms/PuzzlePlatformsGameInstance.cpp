@@ -2,39 +2,50 @@
 
 
 #include "PuzzlePlatformsGameInstance.h"
+#include "PuzzlePlatforms.h"
 #include "Engine/Engine.h"
 #include "TriggerPlatform.h"
-#include "UObject/ConstructorHelpers.h"
-#include "Blueprint/UserWidget.h"
 #include "OnlineSessionSettings.h"
 #include "Interfaces/OnlineSessionInterface.h"
-#include "MenuSystem/MainMenu.h"
-#include "MenuSystem/MenuWidget.h"
+#include "PlatformBenchmark.h"
+#include "PlatformStressTest.h"
+#include "MovingPlatformSubsystem.h"
+#include "BotClient.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Paths.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/FileManager.h"
+#include "Misc/PackageName.h"
+#include "UObject/UObjectIterator.h"
+#include "Containers/Ticker.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
 
 const static FName SESSION_NAME = TEXT("GameSession");
 const static FName SERVER_NAME_SETTINGS_KEY = TEXT("ServerName");
+const static FName PROBE_PORT_SETTINGS_KEY = TEXT("ProbePort");
+const static float SEARCH_POLL_INTERVAL = 0.1f;
+const static FString LOBBY_MAP = TEXT("/Game/PuzzlePlatforms/Maps/Lobby");
+
+DECLARE_CYCLE_STAT(TEXT("Session Create Complete"), STAT_SessionCreateComplete, STATGROUP_PuzzlePlatforms);
+DECLARE_CYCLE_STAT(TEXT("Session Update Complete"), STAT_SessionUpdateComplete, STATGROUP_PuzzlePlatforms);
+DECLARE_CYCLE_STAT(TEXT("Session Destroy Complete"), STAT_SessionDestroyComplete, STATGROUP_PuzzlePlatforms);
+DECLARE_CYCLE_STAT(TEXT("Session Search Merge"), STAT_SessionSearchMerge, STATGROUP_PuzzlePlatforms);
+DECLARE_CYCLE_STAT(TEXT("Session Find Complete"), STAT_SessionFindComplete, STATGROUP_PuzzlePlatforms);
+DECLARE_CYCLE_STAT(TEXT("Session Join Complete"), STAT_SessionJoinComplete, STATGROUP_PuzzlePlatforms);
+DECLARE_CYCLE_STAT(TEXT("Post Load Map"), STAT_PostLoadMap, STATGROUP_PuzzlePlatforms);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Session Cache Hits"), STAT_SessionCacheHits, STATGROUP_PuzzlePlatforms);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Session Cache Misses"), STAT_SessionCacheMisses, STATGROUP_PuzzlePlatforms);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Session Search Latency (ms)"), STAT_SessionSearchLatency, STATGROUP_PuzzlePlatforms);
+
+UPuzzlePlatformsGameInstance::UPuzzlePlatformsGameInstance(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer) {
 
-UPuzzlePlatformsGameInstance::UPuzzlePlatformsGameInstance(const FObjectInitializer& ObjectInitializer) {
-
-	ConstructorHelpers::FClassFinder<UUserWidget> MenuBPClass(TEXT("/Game/MenuSystem/MainMenu_WBP"));
-	
-	if (!ensure(MenuBPClass.Class != nullptr)) return;
-
-	MenuClass = MenuBPClass.Class;
-
-	UE_LOG(LogTemp, Warning, TEXT("Found class %s"), *MenuClass->GetName());
-
-	ConstructorHelpers::FClassFinder<UMenuWidget> InGameMenuBPClass(TEXT("/Game/MenuSystem/InGameMenu_WBP"));
-
-	if (!ensure(InGameMenuBPClass.Class != nullptr)) return;
-
-	InGameMenuClass = InGameMenuBPClass.Class;
-
-	UE_LOG(LogTemp, Warning, TEXT("Found class %s"), *InGameMenuClass->GetName());
 }
 
 
 void UPuzzlePlatformsGameInstance::Init() {
+
+	// Creates the game instance subsystems, the menu subsystem among them.
+	Super::Init();
 	
 	IOnlineSubsystem* Subsystem = IOnlineSubsystem::Get();
 
@@ -50,6 +61,8 @@ void UPuzzlePlatformsGameInstance::Init() {
 
 		SessionInterface->OnCreateSessionCompleteDelegates.AddUObject(this, &UPuzzlePlatformsGameInstance::OnCreateSessionComplete);
 
+		SessionInterface->OnUpdateSessionCompleteDelegates.AddUObject(this, &UPuzzlePlatformsGameInstance::OnUpdateSessionComplete);
+
 		SessionInterface->OnDestroySessionCompleteDelegates.AddUObject(this, &UPuzzlePlatformsGameInstance::OnDestroySessionComplete);
 
 		SessionInterface->OnFindSessionsCompleteDelegates.AddUObject(this, &UPuzzlePlatformsGameInstance::OnFindSessionsComplete);
@@ -62,20 +75,72 @@ void UPuzzlePlatformsGameInstance::Init() {
 		GEngine->OnNetworkFailure().AddUObject(this, &UPuzzlePlatformsGameInstance::OnNetworkFailure);
 
 	}
+
+	FCoreUObjectDelegates::PostLoadMapWithWorld.AddUObject(this, &UPuzzlePlatformsGameInstance::OnPostLoadMap);
+
+	FParse::Value(FCommandLine::Get(), TEXT("MaxPlayers="), MaxPlayers);
+
+	LatencyProber = MakeUnique<FLatencyProber>(MaxOutstandingProbes, ProbesPerSession, ProbeTimeoutSeconds);
+
+	LatencyProber->OnLatencyMeasured.BindUObject(this, &UPuzzlePlatformsGameInstance::OnLatencyMeasured);
+
+	FString BotPattern;
+
+	if (FParse::Value(FCommandLine::Get(), TEXT("PuzzleBot="), BotPattern)) {
+
+		const int64 PatternValue = StaticEnum<EBotPattern>()->GetValueByNameString(BotPattern);
+
+		int32 BotIndex = 0;
+
+		FParse::Value(FCommandLine::Get(), TEXT("BotIndex="), BotIndex);
+
+		BotClient = NewObject<UBotClient>(this);
+
+		BotClient->Start(PatternValue != INDEX_NONE ? EBotPattern(PatternValue) : EBotPattern::Wander, BotIndex);
+	}
 	
 }
 
+void UPuzzlePlatformsGameInstance::Shutdown() {
+
+	// Bot clients are separate processes, and would otherwise outlive the game that launched them.
+	KillBots();
+
+	Super::Shutdown();
+}
+
 void UPuzzlePlatformsGameInstance::Host(FString ServerName) {
 
 	DesiredServerName = ServerName;
 
+	CancelRefreshingServerList();
+
 	if (SessionInterface.IsValid()) {
 
+		HostStartTime = FPlatformTime::Seconds();
+
+		HostPhase = EHostPhase::None;
+
 		auto ExistingSession = SessionInterface->GetNamedSession(SESSION_NAME);
 
 		if (ExistingSession != nullptr) {
 
-			SessionInterface->DestroySession(SESSION_NAME);
+			FOnlineSessionSettings SessionSettings;
+
+			BuildSessionSettings(SessionSettings);
+
+			if (CanUpdateSessionInPlace(*ExistingSession, SessionSettings)) {
+
+				BeginHostPhase(EHostPhase::UpdateSession);
+
+				SessionInterface->UpdateSession(SESSION_NAME, SessionSettings, true);
+			}
+			else {
+
+				BeginHostPhase(EHostPhase::DestroySession);
+
+				SessionInterface->DestroySession(SESSION_NAME);
+			}
 		}
 
 		else {
@@ -88,20 +153,200 @@ void UPuzzlePlatformsGameInstance::Host(FString ServerName) {
 	
 }
 
+void UPuzzlePlatformsGameInstance::OnStart() {
+
+	Super::OnStart();
+
+	if (IsRunningDedicatedServer()) {
+
+		FString ServerName = DedicatedServerName;
+
+		FParse::Value(FCommandLine::Get(), TEXT("ServerName="), ServerName);
+
+		ReportFootprint();
+
+		Host(ServerName);
+	}
+}
+
+void UPuzzlePlatformsGameInstance::BeginHostPhase(EHostPhase Phase) {
+
+	const double Now = FPlatformTime::Seconds();
+
+	if (HostPhase != EHostPhase::None) {
+
+		UE_LOG(LogTemp, Warning, TEXT("Host: %s took %.1fms."), GetHostPhaseName(HostPhase), (Now - HostPhaseStartTime) * 1000.0);
+	}
+
+	if (Phase == EHostPhase::None && HostStartTime > 0.0) {
+
+		UE_LOG(LogTemp, Warning, TEXT("Host: ready after %.1fms."), (Now - HostStartTime) * 1000.0);
+
+		HostStartTime = 0.0;
+	}
+
+	HostPhase = Phase;
+
+	HostPhaseStartTime = Now;
+}
+
+const TCHAR* UPuzzlePlatformsGameInstance::GetHostPhaseName(EHostPhase Phase) {
+
+	switch (Phase) {
+
+	case EHostPhase::CreateSession:
+		return TEXT("CreateSession");
+
+	case EHostPhase::UpdateSession:
+		return TEXT("UpdateSession");
+
+	case EHostPhase::DestroySession:
+		return TEXT("DestroySession");
+
+	case EHostPhase::ServerTravel:
+		return TEXT("ServerTravel");
+
+	default:
+		return TEXT("None");
+	}
+}
+
+void UPuzzlePlatformsGameInstance::OnPostLoadMap(UWorld* LoadedWorld) {
+
+	SCOPE_CYCLE_COUNTER(STAT_PostLoadMap);
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(UPuzzlePlatformsGameInstance::OnPostLoadMap);
+
+	if (HostPhase == EHostPhase::ServerTravel) {
+
+		BeginHostPhase(EHostPhase::None);
+	}
+
+	if (MapTravelStartTime > 0.0) {
+
+		UE_LOG(LogTemp, Warning, TEXT("Travel to %s took %.1fms (%s)."), LoadedWorld != nullptr ? *LoadedWorld->GetMapName() : TEXT("?"), (FPlatformTime::Seconds() - MapTravelStartTime) * 1000.0, PreloadedMap != nullptr ? TEXT("preloaded") : TEXT("cold"));
+
+		MapTravelStartTime = 0.0;
+	}
+
+	// The travelled-to world holds on to its own package now.
+	PreloadedMap = nullptr;
+
+	PreloadMapName.Reset();
+
+	bMapPreloadFailed = false;
+}
+
+void UPuzzlePlatformsGameInstance::PreloadMap(const FString& MapPackageName) {
+
+	if (PreloadMapName == MapPackageName) return;
+
+	PreloadMapName = MapPackageName;
+
+	PreloadedMap = nullptr;
+
+	bMapPreloadFailed = false;
+
+	MapPreloadStartTime = FPlatformTime::Seconds();
+
+	LoadPackageAsync(MapPackageName, FLoadPackageAsyncDelegate::CreateUObject(this, &UPuzzlePlatformsGameInstance::OnMapPreloaded));
+}
+
+void UPuzzlePlatformsGameInstance::OnMapPreloaded(const FName& PackageName, UPackage* LoadedPackage, EAsyncLoadingResult::Type Result) {
+
+	// A later PreloadMap or a travel may have superseded this request.
+	if (PackageName.ToString() != PreloadMapName) return;
+
+	if (Result != EAsyncLoadingResult::Succeeded || LoadedPackage == nullptr) {
+
+		UE_LOG(LogTemp, Warning, TEXT("Could not preload %s."), *PreloadMapName);
+
+		bMapPreloadFailed = true;
+
+		return;
+	}
+
+	PreloadedMap = LoadedPackage;
+
+	UE_LOG(LogTemp, Warning, TEXT("Preloaded %s in %.1fms."), *PreloadMapName, (FPlatformTime::Seconds() - MapPreloadStartTime) * 1000.0);
+}
+
+float UPuzzlePlatformsGameInstance::GetMapPreloadProgress() const {
+
+	if (PreloadedMap != nullptr || bMapPreloadFailed) return 1.f;
+
+	if (PreloadMapName.IsEmpty()) return 0.f;
+
+	const float Percentage = GetAsyncLoadPercentage(FName(*PreloadMapName));
+
+	// Stop short of 1 until the completion callback has run.
+	return Percentage < 0.f ? 0.f : FMath::Min(Percentage / 100.f, 0.99f);
+}
+
+void UPuzzlePlatformsGameInstance::BeginMapTravel() {
+
+	MapTravelStartTime = FPlatformTime::Seconds();
+}
+
+bool UPuzzlePlatformsGameInstance::CanUpdateSessionInPlace(const FNamedOnlineSession& ExistingSession, const FOnlineSessionSettings& SessionSettings) const {
+
+	// A session we joined as a client, or one that changes how it is discovered, has to be recreated.
+	if (!ExistingSession.bHosting) return false;
+
+	// A started session stops answering searches without bAllowJoinInProgress, and the lobby could not start it again.
+	if (ExistingSession.SessionState != EOnlineSessionState::Pending && ExistingSession.SessionState != EOnlineSessionState::Ended) return false;
+
+	if (ExistingSession.SessionSettings.bIsLANMatch != SessionSettings.bIsLANMatch) return false;
+
+	if (ExistingSession.SessionSettings.bUsesPresence != SessionSettings.bUsesPresence) return false;
+
+	// UpdateSession does not recompute NumOpenPublicConnections, so a new capacity would misreport the player count.
+	return SessionSettings.NumPublicConnections == ExistingSession.SessionSettings.NumPublicConnections;
+}
+
+void UPuzzlePlatformsGameInstance::OnUpdateSessionComplete(FName SessionName, bool Succeeded) {
+
+	SCOPE_CYCLE_COUNTER(STAT_SessionUpdateComplete);
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(UPuzzlePlatformsGameInstance::OnUpdateSessionComplete);
+
+	if (HostPhase != EHostPhase::UpdateSession) return;
+
+	if (!Succeeded) {
+
+		UE_LOG(LogTemp, Warning, TEXT("Could not update session in place, recreating it."));
+
+		BeginHostPhase(EHostPhase::DestroySession);
+
+		SessionInterface->DestroySession(SESSION_NAME);
+
+		return;
+	}
+
+	OnSessionReady();
+}
+
 void UPuzzlePlatformsGameInstance::OnCreateSessionComplete(FName SessionName, bool Succeeded) {
 
+	SCOPE_CYCLE_COUNTER(STAT_SessionCreateComplete);
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(UPuzzlePlatformsGameInstance::OnCreateSessionComplete);
+
 	if (!Succeeded) {
 		
 		UE_LOG(LogTemp, Warning, TEXT("Could not create session."));
+
+		HostPhase = EHostPhase::None;
 		
 		return;
 	}
 
+	OnSessionReady();
+}
 
-	if (Menu != nullptr) {
+void UPuzzlePlatformsGameInstance::OnSessionReady() {
 
-		Menu->TearDown();
-	}
+	OnTearDownMenu.Broadcast();
 
 	UEngine* Engine = GetEngine();
 
@@ -113,63 +358,316 @@ void UPuzzlePlatformsGameInstance::OnCreateSessionComplete(FName SessionName, bo
 
 	if (!ensure(World != nullptr)) return;
 
-	World->ServerTravel("/Game/PuzzlePlatforms/Maps/Lobby?listen");
+	// A dedicated server started on the lobby map has nowhere to travel.
+	if (IsRunningDedicatedServer() && UWorld::RemovePIEPrefix(World->GetMapName()) == FPackageName::GetShortName(LOBBY_MAP)) {
+
+		BeginHostPhase(EHostPhase::None);
+
+		return;
+	}
+
+	BeginHostPhase(EHostPhase::ServerTravel);
+
+	// Dedicated servers always listen; only a player hosting needs the listen option.
+	World->ServerTravel(IsRunningDedicatedServer() ? LOBBY_MAP : LOBBY_MAP + TEXT("?listen"));
 }
 
-void UPuzzlePlatformsGameInstance::RefreshingServerList() {
+void UPuzzlePlatformsGameInstance::RefreshingServerList(bool bForceRestart) {
+
+	if (!SessionInterface.IsValid()) return;
 
-	SessionSearch = MakeShareable(new FOnlineSessionSearch());
+	if (!SessionSearch.IsValid()) {
 
-	if (SessionSearch.IsValid()) {
+		SessionSearch = MakeShareable(new FOnlineSessionSearch());
 
 		//SessionSearch->bIsLanQuery = true;
 
 		SessionSearch->MaxSearchResults = 100;
 
 		SessionSearch->QuerySettings.Set(SEARCH_PRESENCE, true, EOnlineComparisonOp::Equals);
+	}
+
+	const bool bSearching = SessionSearch->SearchState == EOnlineAsyncTaskState::InProgress;
+
+	// A hit needs no new search: the cache is fresh, or a running search will still merge into it.
+	const bool bCacheHit = !bForceRestart && (bSearching || IsSessionCacheFresh());
+
+	if (bCacheHit) {
+
+		SessionCacheHits++;
+
+		INC_DWORD_STAT(STAT_SessionCacheHits);
+	}
+	else {
+
+		SessionCacheMisses++;
+
+		INC_DWORD_STAT(STAT_SessionCacheMisses);
+	}
+
+	// Whatever is cached is shown right away; a running or new search merges into it in the background.
+	PublishSearchResults();
+
+	if (bCacheHit) return;
+
+	if (bSearching) {
 
-		UE_LOG(LogTemp, Warning, TEXT("Starting to find Session..."));
+		SessionInterface->CancelFindSessions();
+	}
+
+	SessionSearch->SearchResults.Reset();
+
+	NumMergedResults = 0;
+
+	SearchStartTime = FPlatformTime::Seconds();
+
+	FirstResultLatency = -1.0;
+
+	if (LatencyProber.IsValid()) {
+
+		LatencyProber->Reset();
+	}
+
+	if (!SearchPollHandle.IsValid()) {
+
+		SearchPollHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &UPuzzlePlatformsGameInstance::PollSearchResults), SEARCH_POLL_INTERVAL);
+	}
+
+	UE_LOG(LogTemp, Warning, TEXT("Starting to find Session..."));
+
+	SessionInterface->FindSessions(0, SessionSearch.ToSharedRef());
+}
+
+void UPuzzlePlatformsGameInstance::CancelRefreshingServerList() {
+
+	StopPollingSearchResults();
+
+	if (SessionInterface.IsValid() && SessionSearch.IsValid() && SessionSearch->SearchState == EOnlineAsyncTaskState::InProgress) {
+
+		SessionInterface->CancelFindSessions();
+	}
+}
+
+bool UPuzzlePlatformsGameInstance::IsSessionCacheFresh() const {
+
+	return LastSearchCompleteTime > 0.0 && FPlatformTime::Seconds() - LastSearchCompleteTime < SessionCacheTTL;
+}
+
+bool UPuzzlePlatformsGameInstance::PollSearchResults(float DeltaTime) {
+
+	MergeSearchResults();
+
+	return true;
+}
+
+void UPuzzlePlatformsGameInstance::StopPollingSearchResults() {
+
+	if (SearchPollHandle.IsValid()) {
+
+		FTicker::GetCoreTicker().RemoveTicker(SearchPollHandle);
 
-		SessionInterface->FindSessions(0, SessionSearch.ToSharedRef());
+		SearchPollHandle.Reset();
 	}
 }
 
+FCachedSession* UPuzzlePlatformsGameInstance::FindCachedSession(const FString& SessionId) {
+
+	return SessionCache.FindByPredicate([&SessionId](const FCachedSession& Entry) { return Entry.ServerData.SessionId == SessionId; });
+}
+
+void UPuzzlePlatformsGameInstance::MergeSearchResults() {
+
+	SCOPE_CYCLE_COUNTER(STAT_SessionSearchMerge);
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(UPuzzlePlatformsGameInstance::MergeSearchResults);
+
+	if (!SessionSearch.IsValid()) return;
+
+	// Subsystems that discover sessions incrementally (LAN) append to SearchResults while the search runs.
+	const int32 NumResults = SessionSearch->SearchResults.Num();
+
+	if (NumResults == NumMergedResults) return;
+
+	if (NumMergedResults == 0) {
+
+		FirstResultLatency = FPlatformTime::Seconds() - SearchStartTime;
+	}
+
+	for (int32 i = NumMergedResults; i < NumResults; i++) {
+
+		const FOnlineSessionSearchResult& SearchResult = SessionSearch->SearchResults[i];
+
+		UE_LOG(LogTemp, Warning, TEXT("Found session names: %s"), *SearchResult.GetSessionIdStr());
+
+		FServerData ServerData = MakeServerData(SearchResult);
+
+		FCachedSession* Entry = FindCachedSession(ServerData.SessionId);
+
+		if (Entry == nullptr) {
+
+			Entry = &SessionCache.AddDefaulted_GetRef();
+		}
+		else if (ServerData.PingMs == INDEX_NONE) {
+
+			// Keep the last measured ping until the new probe answers.
+			ServerData.PingMs = Entry->ServerData.PingMs;
+		}
+
+		Entry->SearchResult = SearchResult;
+
+		Entry->ServerData = ServerData;
+
+		Entry->LastSeenTime = SearchStartTime;
+
+		ProbeSession(SearchResult);
+	}
+
+	NumMergedResults = NumResults;
+
+	PublishSearchResults();
+}
+
+void UPuzzlePlatformsGameInstance::PublishSearchResults() {
+
+	ServerDataList.Reset(SessionCache.Num());
+
+	for (const FCachedSession& Entry : SessionCache) {
+
+		ServerDataList.Add(Entry.ServerData);
+	}
+
+	OnServerListChanged.Broadcast(ServerDataList);
+}
+
+FServerData UPuzzlePlatformsGameInstance::MakeServerData(const FOnlineSessionSearchResult& SearchResult) {
+
+	FServerData Data;
+	Data.TotalPlayers = SearchResult.Session.SessionSettings.NumPublicConnections;
+	Data.CurrentPlayers = Data.TotalPlayers - SearchResult.Session.NumOpenPublicConnections;
+
+	FString ServerName;
+	if (SearchResult.Session.SessionSettings.Get(SERVER_NAME_SETTINGS_KEY, ServerName)) {
+
+		Data.Name = ServerName;
+
+	}
+	else {
+
+		Data.Name = "Could Not Find Name";
+	}
+
+	Data.HostUserName = SearchResult.Session.OwningUserName;
+	Data.SessionId = SearchResult.GetSessionIdStr();
+
+	// The subsystem's own ping, if it has one, until a probe answers.
+	Data.PingMs = SearchResult.PingInMs > 0 && SearchResult.PingInMs < MAX_QUERY_PING ? SearchResult.PingInMs : INDEX_NONE;
+
+	return Data;
+}
+
+void UPuzzlePlatformsGameInstance::ProbeSession(const FOnlineSessionSearchResult& SearchResult) {
+
+	if (!LatencyProber.IsValid()) return;
+
+	int32 ProbePort = 0;
+
+	if (!SearchResult.Session.SessionSettings.Get(PROBE_PORT_SETTINGS_KEY, ProbePort) || ProbePort <= 0) return;
+
+	FString ConnectInfo;
+
+	if (!SessionInterface->GetResolvedConnectString(SearchResult, NAME_GamePort, ConnectInfo)) return;
+
+	FString Ip = ConnectInfo;
+
+	int32 PortSeparator = INDEX_NONE;
+
+	if (ConnectInfo.FindLastChar(TEXT(':'), PortSeparator)) {
+
+		Ip = ConnectInfo.Left(PortSeparator);
+	}
+
+	LatencyProber->AddTarget(SearchResult.GetSessionIdStr(), Ip, ProbePort);
+}
+
+void UPuzzlePlatformsGameInstance::OnLatencyMeasured(const FString& SessionId, int32 PingMs) {
+
+	FCachedSession* Entry = FindCachedSession(SessionId);
+
+	if (Entry == nullptr || PingMs == INDEX_NONE) return;
+
+	Entry->ServerData.PingMs = PingMs;
+
+	PublishSearchResults();
+}
+
+void UPuzzlePlatformsGameInstance::SetServerBrowserSort(FString SortMode, int32 MaxPing, bool bHideFull) {
+
+	const int64 SortValue = StaticEnum<EServerSortMode>()->GetValueByNameString(SortMode);
+
+	OnServerSortChanged.Broadcast(SortValue != INDEX_NONE ? EServerSortMode(SortValue) : EServerSortMode::Discovery, MaxPing, bHideFull);
+}
+
 void UPuzzlePlatformsGameInstance::OnFindSessionsComplete(bool Succeeded) {
 
-	if (SessionSearch && Succeeded && Menu != nullptr) {
+	SCOPE_CYCLE_COUNTER(STAT_SessionFindComplete);
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(UPuzzlePlatformsGameInstance::OnFindSessionsComplete);
+
+	StopPollingSearchResults();
+
+	if (SessionSearch && Succeeded) {
 
 		UE_LOG(LogTemp, Warning, TEXT("Finished find session."));
 
-		TArray<FServerData> ServerNames;
+		MergeSearchResults();
 
-		for (FOnlineSessionSearchResult& SearchResult : SessionSearch->SearchResults) {
+		// Sessions the completed search did not return have gone away.
+		const int32 NumRemoved = SessionCache.RemoveAll([this](const FCachedSession& Entry) { return Entry.LastSeenTime < SearchStartTime; });
 
-			UE_LOG(LogTemp, Warning, TEXT("Found session names: %s"), *SearchResult.GetSessionIdStr());
-			FServerData Data;
-			Data.TotalPlayers = SearchResult.Session.SessionSettings.NumPublicConnections;
-			Data.CurrentPlayers = Data.TotalPlayers - SearchResult.Session.NumOpenPublicConnections;
-			
-			FString ServerName;
-			if (SearchResult.Session.SessionSettings.Get(SERVER_NAME_SETTINGS_KEY, ServerName)) {
+		LastSearchCompleteTime = FPlatformTime::Seconds();
 
-				Data.Name = ServerName;
+		LastSearchLatency = LastSearchCompleteTime - SearchStartTime;
 
-			}
-			else {
+		TotalSearchLatency += LastSearchLatency;
 
-				Data.Name = "Could Not Find Name";
-			}
+		NumCompletedSearches++;
 
-			Data.HostUserName = SearchResult.Session.OwningUserName;
-			ServerNames.Add(Data);
-		}
+		SET_FLOAT_STAT(STAT_SessionSearchLatency, LastSearchLatency * 1000.0);
+
+		if (NumRemoved > 0) {
 
-		Menu->SetServerList(ServerNames);
+			PublishSearchResults();
+		}
 	}
 }
 
+void UPuzzlePlatformsGameInstance::SessionCacheStats() {
+
+	const int32 NumOpens = SessionCacheHits + SessionCacheMisses;
+
+	UE_LOG(LogTemp, Warning, TEXT("Session cache: %d entries, %d hits, %d misses (%.0f%% hit rate), fresh for %.1fs more."),
+		SessionCache.Num(), SessionCacheHits, SessionCacheMisses, NumOpens > 0 ? 100.0 * SessionCacheHits / NumOpens : 0.0,
+		IsSessionCacheFresh() ? SessionCacheTTL - (FPlatformTime::Seconds() - LastSearchCompleteTime) : 0.0);
+
+	UE_LOG(LogTemp, Warning, TEXT("Session search: %d completed, last %.0fms, average %.0fms, first result after %.0fms."),
+		NumCompletedSearches, LastSearchLatency * 1000.0, NumCompletedSearches > 0 ? TotalSearchLatency * 1000.0 / NumCompletedSearches : 0.0, FirstResultLatency * 1000.0);
+}
+
+void UPuzzlePlatformsGameInstance::ClearSessionCache() {
+
+	SessionCache.Empty();
+
+	LastSearchCompleteTime = 0.0;
+
+	PublishSearchResults();
+}
+
 void UPuzzlePlatformsGameInstance::OnDestroySessionComplete(FName SessionName, bool Succeeded) {
 
+	SCOPE_CYCLE_COUNTER(STAT_SessionDestroyComplete);
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(UPuzzlePlatformsGameInstance::OnDestroySessionComplete);
+
 	if (Succeeded) {
 
 		CreateSession();
@@ -179,32 +677,56 @@ void UPuzzlePlatformsGameInstance::OnDestroySessionComplete(FName SessionName, b
 
 void UPuzzlePlatformsGameInstance::OnNetworkFailure(UWorld* World, UNetDriver* NetDriver, ENetworkFailure::Type FailureType, const FString& ErrorString) {
 
+	if (IsRunningDedicatedServer()) return;
+
 	LoadMainMenu();
 
 }
 
-void UPuzzlePlatformsGameInstance::CreateSession() {
+void UPuzzlePlatformsGameInstance::BuildSessionSettings(FOnlineSessionSettings& SessionSettings) {
 
-	if (SessionInterface.IsValid()) {
+	if (IOnlineSubsystem::Get()->GetSubsystemName() == "NULL") {
 
-		FOnlineSessionSettings SessionSettings;
+		SessionSettings.bIsLANMatch = true;
+	}
+	else {
 
-		if (IOnlineSubsystem::Get()->GetSubsystemName() == "NULL") {
+		SessionSettings.bIsLANMatch = false;
+	}
 
-			SessionSettings.bIsLANMatch = true;
-		}
-		else {
+	SessionSettings.NumPublicConnections = MaxPlayers;
 
-			SessionSettings.bIsLANMatch = false;
-		}
+	SessionSettings.bShouldAdvertise = true;
+
+	// A headless server has no user to attach presence to.
+	SessionSettings.bIsDedicated = IsRunningDedicatedServer();
+
+	SessionSettings.bUsesPresence = !SessionSettings.bIsDedicated;
+
+	SessionSettings.Set(SERVER_NAME_SETTINGS_KEY, DesiredServerName, EOnlineDataAdvertisementType::ViaOnlineServiceAndPing);
+
+	if (!LatencyEchoServer.IsValid()) {
+
+		LatencyEchoServer = MakeUnique<FLatencyEchoServer>();
+	}
+
+	const int32 ProbePort = LatencyEchoServer->Start(LatencyProbePort, 16);
+
+	if (ProbePort > 0) {
+
+		SessionSettings.Set(PROBE_PORT_SETTINGS_KEY, ProbePort, EOnlineDataAdvertisementType::ViaOnlineServiceAndPing);
+	}
+}
 
-		SessionSettings.NumPublicConnections = 5;
+void UPuzzlePlatformsGameInstance::CreateSession() {
+
+	if (SessionInterface.IsValid()) {
 
-		SessionSettings.bShouldAdvertise = true;
+		FOnlineSessionSettings SessionSettings;
 
-		SessionSettings.bUsesPresence = true;
+		BuildSessionSettings(SessionSettings);
 
-		SessionSettings.Set(SERVER_NAME_SETTINGS_KEY, DesiredServerName, EOnlineDataAdvertisementType::ViaOnlineServiceAndPing);
+		BeginHostPhase(EHostPhase::CreateSession);
 
 		SessionInterface->CreateSession(0, SESSION_NAME, SessionSettings);
 	}
@@ -214,15 +736,15 @@ void UPuzzlePlatformsGameInstance::Join(uint32 Index) {
 
 	if (!ensure(SessionInterface != nullptr)) return;
 
-	if (!ensure(SessionSearch != nullptr)) return;
-	
-	if (Menu != nullptr) {
+	if (!SessionCache.IsValidIndex(Index)) return;
 
-		Menu->TearDown();
+	const FOnlineSessionSearchResult SearchResult = SessionCache[Index].SearchResult;
 
-	}
+	CancelRefreshingServerList();
+	
+	OnTearDownMenu.Broadcast();
 
-	SessionInterface->JoinSession(0, SESSION_NAME, SessionSearch->SearchResults[Index]);
+	SessionInterface->JoinSession(0, SESSION_NAME, SearchResult);
 }
 
 void UPuzzlePlatformsGameInstance::StartSession() {
@@ -237,6 +759,10 @@ void UPuzzlePlatformsGameInstance::StartSession() {
 
 void UPuzzlePlatformsGameInstance::OnJoinSessionComplete(FName SessionName, EOnJoinSessionCompleteResult::Type Result) {
 
+	SCOPE_CYCLE_COUNTER(STAT_SessionJoinComplete);
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(UPuzzlePlatformsGameInstance::OnJoinSessionComplete);
+
 	if (!SessionInterface.IsValid()) return;
 
 	FString Address;
@@ -263,36 +789,197 @@ void UPuzzlePlatformsGameInstance::OnJoinSessionComplete(FName SessionName, EOnJ
 
 void UPuzzlePlatformsGameInstance::LoadMenu() {
 
-	if (!ensure(MenuClass != nullptr)) return;
+	OnLoadMenu.Broadcast();
+}
 
-	Menu = CreateWidget<UMainMenu>(this, MenuClass);
+void UPuzzlePlatformsGameInstance::LoadPauseMenu() {
 
-	if (!ensure(Menu != nullptr)) return;
+	OnLoadPauseMenu.Broadcast();
+}
 
-	Menu->Setup();
+void UPuzzlePlatformsGameInstance::PreloadMenus() {
 
-	Menu->SetMainMenuInterface(this);
+	OnPreloadMenus.Broadcast();
 }
 
-void UPuzzlePlatformsGameInstance::LoadPauseMenu() {
+void UPuzzlePlatformsGameInstance::LoadMainMenu() {
 
-	if (!ensure(InGameMenuClass != nullptr)) return;
+	APlayerController* PlayerController = GetFirstLocalPlayerController();
 
-	UMenuWidget* MenuWidget = CreateWidget<UMenuWidget>(this, InGameMenuClass);
+	if (!ensure(PlayerController != nullptr)) return;
 
-	if (!ensure(MenuWidget != nullptr)) return;
+	PlayerController->ClientTravel("/Game/MenuSystem/MainMenu", ETravelType::TRAVEL_Absolute);
 
-	MenuWidget->Setup();
+}
+
+void UPuzzlePlatformsGameInstance::BenchmarkPlatformPaths(int32 NumPaths, int32 NumEvaluations) {
 
-	MenuWidget->SetMainMenuInterface(this);
+	FPlatformBenchmark::RunPathBenchmark(NumPaths, NumEvaluations);
 }
 
-void UPuzzlePlatformsGameInstance::LoadMainMenu() {
+void UPuzzlePlatformsGameInstance::BenchmarkTriggers(int32 NumPawns, int32 NumFrames) {
 
-	APlayerController* PlayerController = GetFirstLocalPlayerController();
+	FPlatformBenchmark::RunTriggerBenchmark(GetWorld(), NumPawns, NumFrames);
+}
 
-	if (!ensure(PlayerController != nullptr)) return;
+void UPuzzlePlatformsGameInstance::BenchmarkPlatformUpdate(int32 NumFrames) {
 
-	PlayerController->ClientTravel("/Game/MenuSystem/MainMenu", ETravelType::TRAVEL_Absolute);
+	UWorld* World = GetWorld();
+
+	if (!ensure(World != nullptr)) return;
+
+	UMovingPlatformSubsystem* Subsystem = World->GetSubsystem<UMovingPlatformSubsystem>();
+
+	if (!ensure(Subsystem != nullptr)) return;
+
+	Subsystem->RunUpdateBenchmark(NumFrames);
+}
+
+void UPuzzlePlatformsGameInstance::ReportPlatformNetCost() {
+
+	UWorld* World = GetWorld();
+
+	if (!ensure(World != nullptr)) return;
+
+	UMovingPlatformSubsystem* Subsystem = World->GetSubsystem<UMovingPlatformSubsystem>();
+
+	if (!ensure(Subsystem != nullptr)) return;
+
+	Subsystem->ReportNetCost();
+}
+
+void UPuzzlePlatformsGameInstance::StressSpawn(int32 NumPlatforms, int32 NumTriggers) {
+
+	GetStressTest()->SpawnGrid(GetWorld(), NumPlatforms, NumTriggers);
+}
+
+void UPuzzlePlatformsGameInstance::StressOverlaps(float Interval) {
+
+	GetStressTest()->DriveOverlaps(Interval);
+}
+
+void UPuzzlePlatformsGameInstance::StressRecord(float Seconds, FString Label) {
+
+	GetStressTest()->Record(GetWorld(), Seconds, Label);
+}
+
+void UPuzzlePlatformsGameInstance::StressClear() {
+
+	GetStressTest()->Clear();
+}
+
+UPlatformStressTest* UPuzzlePlatformsGameInstance::GetStressTest() {
+
+	if (StressTest == nullptr) {
+
+		StressTest = NewObject<UPlatformStressTest>(this);
+	}
+
+	return StressTest;
+}
+
+void UPuzzlePlatformsGameInstance::SpawnBots(int32 Count, FString Pattern, FString Address) {
+
+	if (Address.IsEmpty()) {
+
+		Address = TEXT("127.0.0.1");
+	}
+
+	if (Pattern.IsEmpty()) {
 
-}
\ No newline at end of file
+		Pattern = TEXT("Wander");
+	}
+
+	FString BaseParams;
+
+	// Uncooked builds run through the editor executable and need the project and -game.
+	if (!FPlatformProperties::RequiresCookedData()) {
+
+		BaseParams = FString::Printf(TEXT("\"%s\" -game "), *FPaths::ConvertRelativePathToFull(FPaths::GetProjectFilePath()));
+	}
+
+	for (int32 i = 0; i < Count; i++) {
+
+		const int32 BotIndex = BotProcesses.Num();
+
+		const FString Params = BaseParams + FString::Printf(TEXT("%s -nullrhi -nosound -unattended -PuzzleBot=%s -BotIndex=%d -log=PuzzleBot_%d.log"), *Address, *Pattern, BotIndex, BotIndex);
+
+		FProcHandle Handle = FPlatformProcess::CreateProc(FPlatformProcess::ExecutablePath(), *Params, true, true, true, nullptr, 0, nullptr, nullptr);
+
+		if (!Handle.IsValid()) {
+
+			UE_LOG(LogTemp, Warning, TEXT("Could not launch bot %d."), BotIndex);
+			continue;
+		}
+
+		BotProcesses.Add(Handle);
+	}
+
+	UE_LOG(LogTemp, Warning, TEXT("%d bot clients running against %s."), BotProcesses.Num(), *Address);
+}
+
+void UPuzzlePlatformsGameInstance::KillBots() {
+
+	for (FProcHandle& Handle : BotProcesses) {
+
+		if (FPlatformProcess::IsProcRunning(Handle)) {
+
+			FPlatformProcess::TerminateProc(Handle);
+		}
+
+		FPlatformProcess::CloseProc(Handle);
+	}
+
+	BotProcesses.Empty();
+}
+
+void UPuzzlePlatformsGameInstance::ReportFootprint() {
+
+	const FPlatformMemoryStats MemoryStats = FPlatformMemory::GetStats();
+
+	const int64 ExecutableSize = IFileManager::Get().FileSize(FPlatformProcess::ExecutablePath());
+
+	int32 NumObjects = 0;
+
+	int32 NumClasses = 0;
+
+	for (FThreadSafeObjectIterator It; It; ++It) {
+
+		NumObjects++;
+
+		if (It->IsA<UClass>()) {
+
+			NumClasses++;
+		}
+	}
+
+	UE_LOG(LogTemp, Warning, TEXT("Footprint (%s): executable %.1f MB, resident %.1f MB (peak %.1f MB), %d objects, %d classes, menu module %s."),
+		IsRunningDedicatedServer() ? TEXT("server") : TEXT("client"),
+		ExecutableSize / (1024.0 * 1024.0),
+		MemoryStats.UsedPhysical / (1024.0 * 1024.0),
+		MemoryStats.PeakUsedPhysical / (1024.0 * 1024.0),
+		NumObjects, NumClasses,
+		FModuleManager::Get().IsModuleLoaded(TEXT("PuzzlePlatformsMenu")) ? TEXT("loaded") : TEXT("absent"));
+}
+
+int32 UPuzzlePlatformsGameInstance::GetSessionCapacity() const {
+
+	if (SessionInterface.IsValid()) {
+
+		const FNamedOnlineSession* Session = SessionInterface->GetNamedSession(SESSION_NAME);
+
+		if (Session != nullptr) {
+
+			return Session->SessionSettings.NumPublicConnections;
+		}
+	}
+
+	return MaxPlayers;
+}
+
+void UPuzzlePlatformsGameInstance::SetMaxPlayers(int32 InMaxPlayers) {
+
+	MaxPlayers = FMath::Max(1, InMaxPlayers);
+
+	UE_LOG(LogTemp, Warning, TEXT("Sessions will be hosted with %d public connections."), MaxPlayers);
+}
@@ -7,12 +7,45 @@
 #include "OnlineSubsystem.h"
 #include "MenuSystem/MainMenuInterface.h"
 #include "Interfaces/OnlineSessionInterface.h"
+#include "MenuSystem/ServerData.h"
+#include "LatencyProbe.h"
+#include "OnlineSessionSettings.h"
 #include "PuzzlePlatformsGameInstance.generated.h"
 
+DECLARE_MULTICAST_DELEGATE(FOnMenuRequest);
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnServerListChanged, const TArray<FServerData>&);
+DECLARE_MULTICAST_DELEGATE_ThreeParams(FOnServerSortChanged, EServerSortMode, int32, bool);
+
+/** Steps of hosting a session, timed and logged by the game instance. */
+enum class EHostPhase : uint8 {
+
+	/** Not hosting, or the session is ready. */
+	None,
+
+	CreateSession,
+
+	UpdateSession,
+
+	DestroySession,
+
+	ServerTravel
+};
+
+/** A discovered session kept between searches so the join menu can show it immediately. */
+struct FCachedSession {
+
+	FOnlineSessionSearchResult SearchResult;
+
+	FServerData ServerData;
+
+	/** Start time of the last search that returned this session. */
+	double LastSeenTime = 0.0;
+};
+
 /**
  * 
  */
-UCLASS()
+UCLASS(Config = Game)
 class PUZZLEPLATFORMS_API UPuzzlePlatformsGameInstance : public UGameInstance, public IMainMenuInterface
 {
 	GENERATED_BODY()
@@ -23,7 +56,22 @@ public:
 		const FObjectInitializer& ObjectInitializer
 	);
 
-	void Init();
+	virtual void Init() override;
+
+	virtual void Shutdown() override;
+
+	/** Menu requests, handled by the client-only PuzzlePlatformsMenu module when it is present. */
+	FOnMenuRequest OnLoadMenu;
+
+	FOnMenuRequest OnLoadPauseMenu;
+
+	FOnMenuRequest OnPreloadMenus;
+
+	FOnMenuRequest OnTearDownMenu;
+
+	FOnServerListChanged OnServerListChanged;
+
+	FOnServerSortChanged OnServerSortChanged;
 
 	UFUNCTION(BlueprintCallable)
 	void LoadMenu();
@@ -31,6 +79,14 @@ public:
 	UFUNCTION(BlueprintCallable)
 	void LoadPauseMenu();
 
+	/** Starts loading the menu widget classes so the first LoadMenu or LoadPauseMenu does not wait on them. */
+	UFUNCTION(BlueprintCallable)
+	void PreloadMenus();
+
+	/** Logs executable size, process memory and loaded object counts to compare client and server builds. */
+	UFUNCTION(Exec)
+	void ReportFootprint();
+
 	UFUNCTION(Exec)
 	virtual void Host(FString ServerName) override;
 
@@ -40,17 +96,118 @@ public:
 	UFUNCTION()
 	virtual void LoadMainMenu() override;
 
-	virtual void RefreshingServerList() override;
+	UFUNCTION(Exec)
+	void BenchmarkPlatformPaths(int32 NumPaths = 1000, int32 NumEvaluations = 1000);
+
+	/** Compares overlap components against the trigger spatial hash at 1k, 10k and 50k triggers. */
+	UFUNCTION(Exec)
+	void BenchmarkTriggers(int32 NumPawns = 16, int32 NumFrames = 300);
+
+	/** Times the platform location update serially and across task graph workers, over the platforms of the current world. */
+	UFUNCTION(Exec)
+	void BenchmarkPlatformUpdate(int32 NumFrames = 100);
+
+	/** Compares the per-platform replication cost of NetState against replicated movement in the current world. */
+	UFUNCTION(Exec)
+	void ReportPlatformNetCost();
+
+	UFUNCTION(Exec)
+	void StressSpawn(int32 NumPlatforms, int32 NumTriggers);
+
+	UFUNCTION(Exec)
+	void StressOverlaps(float Interval);
+
+	UFUNCTION(Exec)
+	void StressRecord(float Seconds, FString Label);
+
+	UFUNCTION(Exec)
+	void StressClear();
+
+	/** Launches Count headless bot client processes that connect to Address (defaults to this machine). */
+	UFUNCTION(Exec)
+	void SpawnBots(int32 Count, FString Pattern, FString Address);
+
+	UFUNCTION(Exec)
+	void KillBots();
+
+	UFUNCTION(Exec)
+	void SetMaxPlayers(int32 InMaxPlayers);
+
+	int32 GetMaxPlayers() const { return MaxPlayers; }
+
+	/** Public connections of the live session, or MaxPlayers when there is none. */
+	int32 GetSessionCapacity() const;
+
+	/** Sorts the server browser by Discovery, Ping or Fill and hides hosts above MaxPing (0 for no limit) or full ones. */
+	UFUNCTION(Exec)
+	void SetServerBrowserSort(FString SortMode, int32 MaxPing, bool bHideFull);
+
+	virtual void RefreshingServerList(bool bForceRestart = false) override;
+
+	virtual void CancelRefreshingServerList() override;
+
+	/** Logs session cache hits, misses and search latency. */
+	UFUNCTION(Exec)
+	void SessionCacheStats();
+
+	UFUNCTION(Exec)
+	void ClearSessionCache();
 
 	void StartSession();
 
+	/** Starts loading a map package in the background and keeps it in memory for the next travel. */
+	void PreloadMap(const FString& MapPackageName);
+
+	/** Progress of the last PreloadMap, from 0 to 1. A failed preload counts as done so it never holds up travel. */
+	float GetMapPreloadProgress() const;
+
+	/** Marks the start of a map travel; the travel time is logged once the new map has loaded. */
+	void BeginMapTravel();
+
+protected:
+
+	virtual void OnStart() override;
+
 private:
 
-	TSubclassOf<class UUserWidget> MenuClass;
+	/** Name a dedicated server advertises its session under. Overridden by -ServerName= on the command line. */
+	UPROPERTY(Config)
+	FString DedicatedServerName = TEXT("Dedicated Server");
+
+	/** Public connections of the hosted session. Overridden by -MaxPlayers= on the command line. */
+	UPROPERTY(Config)
+	int32 MaxPlayers = 5;
+
+	UPROPERTY()
+	class UPlatformStressTest* StressTest;
+
+	class UPlatformStressTest* GetStressTest();
+
+	UPROPERTY()
+	class UBotClient* BotClient;
+
+	TArray<FProcHandle> BotProcesses;
+
+	/** First UDP port tried for answering latency probes while hosting. */
+	UPROPERTY(Config)
+	int32 LatencyProbePort = 7787;
+
+	UPROPERTY(Config)
+	int32 MaxOutstandingProbes = 16;
+
+	UPROPERTY(Config)
+	int32 ProbesPerSession = 3;
 
-	TSubclassOf<class UUserWidget> InGameMenuClass;
-	
-	class UMainMenu* Menu;
+	UPROPERTY(Config)
+	float ProbeTimeoutSeconds = 1.f;
+
+	TUniquePtr<FLatencyEchoServer> LatencyEchoServer;
+
+	TUniquePtr<FLatencyProber> LatencyProber;
+
+	void ProbeSession(const class FOnlineSessionSearchResult& SearchResult);
+
+	void OnLatencyMeasured(const FString& SessionId, int32 PingMs);
 
 	IOnlineSessionPtr SessionInterface;
 
@@ -58,8 +215,89 @@ private:
 
 	FString DesiredServerName;
 
+	/** Seconds a completed search stays fresh. Opening the join menu within it shows the cache without searching again. */
+	UPROPERTY(Config)
+	float SessionCacheTTL = 30.f;
+
+	/** Sessions from previous and running searches. Join indexes into it. */
+	TArray<FCachedSession> SessionCache;
+
+	/** Menu rows for SessionCache, in the same order. */
+	TArray<FServerData> ServerDataList;
+
+	/** Results of the running search already merged into SessionCache. */
+	int32 NumMergedResults = 0;
+
+	double SearchStartTime = 0.0;
+
+	double LastSearchCompleteTime = 0.0;
+
+	int32 SessionCacheHits = 0;
+
+	int32 SessionCacheMisses = 0;
+
+	int32 NumCompletedSearches = 0;
+
+	double LastSearchLatency = 0.0;
+
+	double TotalSearchLatency = 0.0;
+
+	double FirstResultLatency = -1.0;
+
+	bool IsSessionCacheFresh() const;
+
+	void MergeSearchResults();
+
+	FDelegateHandle SearchPollHandle;
+
+	bool PollSearchResults(float DeltaTime);
+
+	void StopPollingSearchResults();
+
+	void PublishSearchResults();
+
+	FCachedSession* FindCachedSession(const FString& SessionId);
+
+	static FServerData MakeServerData(const class FOnlineSessionSearchResult& SearchResult);
+
+	/** Time Host was called and the start of the current hosting phase, for the phase timings. */
+	double HostStartTime = 0.0;
+
+	double HostPhaseStartTime = 0.0;
+
+	EHostPhase HostPhase = EHostPhase::None;
+
+	void BeginHostPhase(EHostPhase Phase);
+
+	static const TCHAR* GetHostPhaseName(EHostPhase Phase);
+
+	void OnPostLoadMap(UWorld* LoadedWorld);
+
+	FString PreloadMapName;
+
+	/** Keeps the preloaded map from being garbage collected before the travel picks it up. */
+	UPROPERTY()
+	UPackage* PreloadedMap = nullptr;
+
+	bool bMapPreloadFailed = false;
+
+	double MapPreloadStartTime = 0.0;
+
+	double MapTravelStartTime = 0.0;
+
+	void OnMapPreloaded(const FName& PackageName, UPackage* LoadedPackage, EAsyncLoadingResult::Type Result);
+
+	void BuildSessionSettings(FOnlineSessionSettings& SessionSettings);
+
+	/** Whether the live session can take the new settings through UpdateSession instead of being recreated. */
+	bool CanUpdateSessionInPlace(const class FNamedOnlineSession& ExistingSession, const FOnlineSessionSettings& SessionSettings) const;
+
+	void OnSessionReady();
+
 	void OnCreateSessionComplete(FName SessionName, bool Succeeded);
 
+	void OnUpdateSessionComplete(FName SessionName, bool Succeeded);
+
 	void OnDestroySessionComplete(FName SessionName, bool Succeeded);
 
 	void OnFindSessionsComplete(bool Succeeded);
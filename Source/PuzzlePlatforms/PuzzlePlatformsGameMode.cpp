@@ -2,6 +2,8 @@
 
 #include "PuzzlePlatformsGameMode.h"
 #include "PuzzlePlatformsCharacter.h"
+#include "PuzzlePlatformsGameInstance.h"
+#include "GameFramework/GameSession.h"
 #include "UObject/ConstructorHelpers.h"
 
 APuzzlePlatformsGameMode::APuzzlePlatformsGameMode()
@@ -13,3 +15,90 @@ APuzzlePlatformsGameMode::APuzzlePlatformsGameMode()
 		DefaultPawnClass = PlayerPawnBPClass.Class;
 	}
 }
+
+void APuzzlePlatformsGameMode::InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage)
+{
+	Super::InitGame(MapName, Options, ErrorMessage);
+
+	// Let the game session admit as many players as the hosted session advertises.
+	UPuzzlePlatformsGameInstance* GameInstance = Cast<UPuzzlePlatformsGameInstance>(GetGameInstance());
+
+	if (GameInstance != nullptr && GameSession != nullptr)
+	{
+		GameSession->MaxPlayers = FMath::Max(GameSession->MaxPlayers, GameInstance->GetMaxPlayers());
+	}
+}
+
+void APuzzlePlatformsGameMode::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Only servers with remote players have a match worth reporting.
+	if (bWriteMatchReports && (GetNetMode() == NM_DedicatedServer || GetNetMode() == NM_ListenServer))
+	{
+		MatchRecorder = MakeUnique<FMatchRecorder>();
+
+		MatchRecorder->Start(GetWorld());
+
+		for (const TWeakObjectPtr<APlayerController>& Player : PendingTravelPlayers)
+		{
+			MatchRecorder->OnPlayerJoined(Player.Get());
+		}
+	}
+
+	PendingTravelPlayers.Empty();
+}
+
+void APuzzlePlatformsGameMode::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (MatchRecorder.IsValid())
+	{
+		MatchRecorder->Finish();
+
+		MatchRecorder.Reset();
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void APuzzlePlatformsGameMode::PreLogin(const FString& Options, const FString& Address, const FUniqueNetIdRepl& UniqueId, FString& ErrorMessage)
+{
+	Super::PreLogin(Options, Address, UniqueId, ErrorMessage);
+
+	if (MatchRecorder.IsValid() && ErrorMessage.IsEmpty())
+	{
+		MatchRecorder->OnLoginRequest(Address);
+	}
+}
+
+void APuzzlePlatformsGameMode::PostLogin(APlayerController* NewPlayer)
+{
+	Super::PostLogin(NewPlayer);
+
+	if (MatchRecorder.IsValid())
+	{
+		MatchRecorder->OnPlayerJoined(NewPlayer);
+	}
+}
+
+void APuzzlePlatformsGameMode::HandleSeamlessTravelPlayer(AController*& C)
+{
+	Super::HandleSeamlessTravelPlayer(C);
+
+	// C may have been replaced by a controller of the new map's class.
+	APlayerController* Player = Cast<APlayerController>(C);
+
+	if (Player == nullptr)
+	{
+		return;
+	}
+
+	if (MatchRecorder.IsValid())
+	{
+		MatchRecorder->OnPlayerJoined(Player);
+	}
+	else if (!HasActorBegunPlay())
+	{
+		PendingTravelPlayers.Add(Player);
+	}
+}
@@ -4,15 +4,42 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/GameModeBase.h"
+#include "MatchReport.h"
 #include "PuzzlePlatformsGameMode.generated.h"
 
-UCLASS(minimalapi)
+UCLASS(minimalapi, Config = Game)
 class APuzzlePlatformsGameMode : public AGameModeBase
 {
 	GENERATED_BODY()
 
 public:
 	APuzzlePlatformsGameMode();
+
+	virtual void InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage) override;
+
+	virtual void PreLogin(const FString& Options, const FString& Address, const FUniqueNetIdRepl& UniqueId, FString& ErrorMessage) override;
+
+	virtual void PostLogin(APlayerController* NewPlayer) override;
+
+	/** Seamless travel brings players over without PreLogin or PostLogin, so their arrival is recorded here. */
+	virtual void HandleSeamlessTravelPlayer(AController*& C) override;
+
+protected:
+
+	virtual void BeginPlay() override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+
+	/** Write a per-match report to Saved/MatchReports when a server's game mode ends. */
+	UPROPERTY(Config)
+	bool bWriteMatchReports = true;
+
+	TUniquePtr<FMatchRecorder> MatchRecorder;
+
+	/** Players that arrived by seamless travel before BeginPlay started the recorder. */
+	TArray<TWeakObjectPtr<APlayerController>> PendingTravelPlayers;
 };
 
 
@@ -0,0 +1,265 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "PuzzlePlatformsReplicationGraph.h"
+#include "PuzzlePlatforms.h"
+#include "ReplicationGraphTypes.h"
+#include "Engine/NetDriver.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerState.h"
+#include "GameFramework/GameStateBase.h"
+#include "GameFramework/Info.h"
+#include "HAL/IConsoleManager.h"
+#include "UObject/UObjectIterator.h"
+#include "MovingPlatform.h"
+#include "TriggerPlatform.h"
+
+DECLARE_CYCLE_STAT(TEXT("Replication Graph ServerReplicateActors"), STAT_RepGraphServerReplicateActors, STATGROUP_PuzzlePlatforms);
+
+static FAutoConsoleCommandWithWorldAndArgs CVarRepGraphStress(
+	TEXT("PuzzlePlatforms.RepGraph.Stress"),
+	TEXT("PuzzlePlatforms.RepGraph.Stress [Frames] [Connections...]. Records replication graph time per frame for Frames frames (default 600) ")
+	TEXT("once the server reaches each connection count (default 16 32 64), and logs the results."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World) {
+
+		UNetDriver* NetDriver = World != nullptr ? World->GetNetDriver() : nullptr;
+
+		UPuzzlePlatformsReplicationGraph* Graph = NetDriver != nullptr ? Cast<UPuzzlePlatformsReplicationGraph>(NetDriver->GetReplicationDriver()) : nullptr;
+
+		if (Graph == nullptr) {
+
+			UE_LOG(LogTemp, Warning, TEXT("PuzzlePlatforms.RepGraph.Stress must be run on a server using UPuzzlePlatformsReplicationGraph."));
+			return;
+		}
+
+		TArray<int32> ConnectionTargets;
+
+		for (int32 i = 1; i < Args.Num(); i++) {
+
+			ConnectionTargets.Add(FCString::Atoi(*Args[i]));
+		}
+
+		if (ConnectionTargets.Num() == 0) {
+
+			ConnectionTargets = { 16, 32, 64 };
+		}
+
+		Graph->BeginStressCapture(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 600, ConnectionTargets);
+	})
+);
+
+void UPuzzlePlatformsReplicationGraph::InitGlobalActorClassSettings() {
+
+	Super::InitGlobalActorClassSettings();
+
+	ClassRepNodePolicies.Set(AMovingPlatform::StaticClass(), EClassRepNodeMapping::Spatialize_Dormancy);
+	ClassRepNodePolicies.Set(ATriggerPlatform::StaticClass(), EClassRepNodeMapping::Spatialize_Static);
+	ClassRepNodePolicies.Set(APawn::StaticClass(), EClassRepNodeMapping::Spatialize_Dynamic);
+	ClassRepNodePolicies.Set(APlayerController::StaticClass(), EClassRepNodeMapping::NotRouted);
+	ClassRepNodePolicies.Set(APlayerState::StaticClass(), EClassRepNodeMapping::RelevantAllConnections);
+	ClassRepNodePolicies.Set(AGameStateBase::StaticClass(), EClassRepNodeMapping::RelevantAllConnections);
+
+	const float ServerMaxTickRate = NetDriver != nullptr ? NetDriver->NetServerMaxTickRate : 30.f;
+
+	for (TObjectIterator<UClass> It; It; ++It) {
+
+		UClass* Class = *It;
+
+		AActor* ActorCDO = Cast<AActor>(Class->GetDefaultObject(false));
+
+		if (ActorCDO == nullptr || !ActorCDO->GetIsReplicated()) continue;
+
+		if (Class->GetName().StartsWith(TEXT("SKEL_")) || Class->GetName().StartsWith(TEXT("REINST_"))) continue;
+
+		const EClassRepNodeMapping Mapping = GetMappingPolicy(Class);
+
+		FClassReplicationInfo ClassInfo;
+
+		ClassInfo.ReplicationPeriodFrame = FMath::Max<uint32>(FMath::RoundToInt(ServerMaxTickRate / FMath::Max(ActorCDO->NetUpdateFrequency, 1.f)), 1);
+
+		if (Mapping >= EClassRepNodeMapping::Spatialize_Static) {
+
+			const float CullDistanceSquared = ActorCDO->NetCullDistanceSquared > 0.f ? ActorCDO->NetCullDistanceSquared : FMath::Square(DefaultCullDistance);
+
+			ClassInfo.SetCullDistanceSquared(CullDistanceSquared);
+		}
+
+		GlobalActorReplicationInfoMap.SetClassInfo(Class, ClassInfo);
+	}
+}
+
+EClassRepNodeMapping UPuzzlePlatformsReplicationGraph::GetMappingPolicy(UClass* Class) {
+
+	if (const EClassRepNodeMapping* Mapping = ClassRepNodePolicies.Get(Class)) {
+
+		return *Mapping;
+	}
+
+	AActor* ActorCDO = Cast<AActor>(Class->GetDefaultObject());
+
+	EClassRepNodeMapping Mapping = EClassRepNodeMapping::Spatialize_Dynamic;
+
+	if (ActorCDO == nullptr || ActorCDO->bOnlyRelevantToOwner) {
+
+		Mapping = EClassRepNodeMapping::NotRouted;
+	}
+	else if (ActorCDO->bAlwaysRelevant || Class->IsChildOf(AInfo::StaticClass())) {
+
+		Mapping = EClassRepNodeMapping::RelevantAllConnections;
+	}
+
+	ClassRepNodePolicies.Set(Class, Mapping);
+
+	return Mapping;
+}
+
+void UPuzzlePlatformsReplicationGraph::InitGlobalGraphNodes() {
+
+	Super::InitGlobalGraphNodes();
+
+	GridNode = CreateNewNode<UReplicationGraphNode_GridSpatialization2D>();
+
+	GridNode->CellSize = GridCellSize;
+
+	GridNode->SpatialBias = FVector2D(SpatialBiasX, SpatialBiasY);
+
+	AddGlobalGraphNode(GridNode);
+
+	AlwaysRelevantNode = CreateNewNode<UReplicationGraphNode_ActorList>();
+
+	AddGlobalGraphNode(AlwaysRelevantNode);
+}
+
+void UPuzzlePlatformsReplicationGraph::InitConnectionGraphNodes(UNetReplicationGraphConnection* RepGraphConnection) {
+
+	Super::InitConnectionGraphNodes(RepGraphConnection);
+
+	// Adds the connection's own player controller and view target.
+	UReplicationGraphNode_AlwaysRelevant_ForConnection* ConnectionNode = CreateNewNode<UReplicationGraphNode_AlwaysRelevant_ForConnection>();
+
+	AddConnectionGraphNode(ConnectionNode, RepGraphConnection);
+}
+
+void UPuzzlePlatformsReplicationGraph::RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo) {
+
+	switch (GetMappingPolicy(ActorInfo.Class)) {
+
+	case EClassRepNodeMapping::RelevantAllConnections:
+		AlwaysRelevantNode->NotifyAddNetworkActor(ActorInfo);
+		break;
+
+	case EClassRepNodeMapping::Spatialize_Static:
+		GridNode->AddActor_Static(ActorInfo, GlobalInfo);
+		break;
+
+	case EClassRepNodeMapping::Spatialize_Dynamic:
+		GridNode->AddActor_Dynamic(ActorInfo, GlobalInfo);
+		break;
+
+	case EClassRepNodeMapping::Spatialize_Dormancy:
+		GridNode->AddActor_Dormancy(ActorInfo, GlobalInfo);
+		break;
+
+	default:
+		break;
+	}
+}
+
+void UPuzzlePlatformsReplicationGraph::RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo) {
+
+	switch (GetMappingPolicy(ActorInfo.Class)) {
+
+	case EClassRepNodeMapping::RelevantAllConnections:
+		AlwaysRelevantNode->NotifyRemoveNetworkActor(ActorInfo);
+		break;
+
+	case EClassRepNodeMapping::Spatialize_Static:
+		GridNode->RemoveActor_Static(ActorInfo);
+		break;
+
+	case EClassRepNodeMapping::Spatialize_Dynamic:
+		GridNode->RemoveActor_Dynamic(ActorInfo);
+		break;
+
+	case EClassRepNodeMapping::Spatialize_Dormancy:
+		GridNode->RemoveActor_Dormancy(ActorInfo);
+		break;
+
+	default:
+		break;
+	}
+}
+
+int32 UPuzzlePlatformsReplicationGraph::ServerReplicateActors(float DeltaSeconds) {
+
+	SCOPE_CYCLE_COUNTER(STAT_RepGraphServerReplicateActors);
+
+	if (StressFramesRemaining <= 0 && StressConnectionTargets.Num() > 0 && Connections.Num() >= StressConnectionTargets[0]) {
+
+		StartCapture();
+	}
+
+	if (StressFramesRemaining <= 0) {
+
+		return Super::ServerReplicateActors(DeltaSeconds);
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	const int32 NumReplicated = Super::ServerReplicateActors(DeltaSeconds);
+
+	const double FrameSeconds = FPlatformTime::Seconds() - StartTime;
+
+	StressTotalSeconds += FrameSeconds;
+
+	StressMaxSeconds = FMath::Max(StressMaxSeconds, FrameSeconds);
+
+	StressMaxConnections = FMath::Max(StressMaxConnections, Connections.Num());
+
+	StressFramesCaptured++;
+
+	if (--StressFramesRemaining == 0) {
+
+		EndCapture();
+	}
+
+	return NumReplicated;
+}
+
+void UPuzzlePlatformsReplicationGraph::BeginStressCapture(int32 NumFrames, const TArray<int32>& ConnectionTargets) {
+
+	StressFramesPerCapture = FMath::Max(1, NumFrames);
+
+	StressFramesRemaining = 0;
+
+	StressConnectionTargets = ConnectionTargets;
+
+	StressConnectionTargets.Sort();
+
+	UE_LOG(LogTemp, Warning, TEXT("RepGraph stress: %d frames per capture, currently %d connections."), StressFramesPerCapture, Connections.Num());
+}
+
+void UPuzzlePlatformsReplicationGraph::StartCapture() {
+
+	StressConnectionTargets.RemoveAt(0);
+
+	StressFramesRemaining = StressFramesPerCapture;
+
+	StressFramesCaptured = 0;
+
+	StressTotalSeconds = 0.0;
+
+	StressMaxSeconds = 0.0;
+
+	StressMaxConnections = Connections.Num();
+}
+
+void UPuzzlePlatformsReplicationGraph::EndCapture() {
+
+	const double AverageMs = StressFramesCaptured > 0 ? StressTotalSeconds * 1000.0 / StressFramesCaptured : 0.0;
+
+	UE_LOG(LogTemp, Warning, TEXT("RepGraph stress: %d connections, %d frames, %.3f ms avg / %.3f ms max replication time per frame, %.3f us per connection."),
+		StressMaxConnections, StressFramesCaptured, AverageMs, StressMaxSeconds * 1000.0, StressMaxConnections > 0 ? AverageMs * 1000.0 / StressMaxConnections : 0.0);
+}
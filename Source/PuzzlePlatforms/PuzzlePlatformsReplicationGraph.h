@@ -0,0 +1,99 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ReplicationGraph.h"
+#include "PuzzlePlatformsReplicationGraph.generated.h"
+
+enum class EClassRepNodeMapping : uint32 {
+
+	/** Not routed to any node. Owner-only actors such as player controllers go through the per-connection node. */
+	NotRouted,
+
+	/** Replicated to every connection. */
+	RelevantAllConnections,
+
+	/** Spatialized, never moves. */
+	Spatialize_Static,
+
+	/** Spatialized, moves every frame. */
+	Spatialize_Dynamic,
+
+	/** Spatialized, treated as static while dormant. */
+	Spatialize_Dormancy,
+};
+
+/**
+ * Replication graph for the project. Platforms, triggers and characters live in a 2D spatial grid so each
+ * connection only gathers the cells around its viewer, and dormant platforms cost nothing per connection.
+ * Game state and player states go through a single always-relevant list.
+ */
+UCLASS(Transient, Config = Engine)
+class PUZZLEPLATFORMS_API UPuzzlePlatformsReplicationGraph : public UReplicationGraph
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void InitGlobalActorClassSettings() override;
+
+	virtual void InitGlobalGraphNodes() override;
+
+	virtual void InitConnectionGraphNodes(UNetReplicationGraphConnection* RepGraphConnection) override;
+
+	virtual void RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo) override;
+
+	virtual void RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo) override;
+
+	virtual int32 ServerReplicateActors(float DeltaSeconds) override;
+
+	/**
+	 * Records replication time per frame for NumFrames frames each time the connection count first reaches
+	 * one of ConnectionTargets, and logs the results.
+	 */
+	void BeginStressCapture(int32 NumFrames, const TArray<int32>& ConnectionTargets);
+
+	UPROPERTY(Config)
+	float GridCellSize = 10000.f;
+
+	UPROPERTY(Config)
+	float SpatialBiasX = -150000.f;
+
+	UPROPERTY(Config)
+	float SpatialBiasY = -200000.f;
+
+	/** Default cull distance for spatialized actors that don't set their own NetCullDistanceSquared. */
+	UPROPERTY(Config)
+	float DefaultCullDistance = 15000.f;
+
+private:
+
+	UPROPERTY()
+	class UReplicationGraphNode_GridSpatialization2D* GridNode;
+
+	UPROPERTY()
+	class UReplicationGraphNode_ActorList* AlwaysRelevantNode;
+
+	TClassMap<EClassRepNodeMapping> ClassRepNodePolicies;
+
+	EClassRepNodeMapping GetMappingPolicy(UClass* Class);
+
+	TArray<int32> StressConnectionTargets;
+
+	int32 StressFramesPerCapture = 0;
+
+	int32 StressFramesRemaining = 0;
+
+	int32 StressFramesCaptured = 0;
+
+	double StressTotalSeconds = 0.0;
+
+	double StressMaxSeconds = 0.0;
+
+	int32 StressMaxConnections = 0;
+
+	void StartCapture();
+
+	void EndCapture();
+};
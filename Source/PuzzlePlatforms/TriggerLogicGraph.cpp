@@ -0,0 +1,40 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TriggerLogicGraph.h"
+#include "TriggerLogicSubsystem.h"
+
+ATriggerLogicGraph::ATriggerLogicGraph() {
+
+	PrimaryActorTick.bCanEverTick = false;
+
+	bReplicates = false;
+}
+
+void ATriggerLogicGraph::BeginPlay() {
+
+	Super::BeginPlay();
+
+	// The graph does not replicate, so clients keep authority over their copy; the net mode tells them apart.
+	if (GetNetMode() == NM_Client) return;
+
+	UTriggerLogicSubsystem* Subsystem = GetWorld()->GetSubsystem<UTriggerLogicSubsystem>();
+
+	if (!ensure(Subsystem != nullptr)) return;
+
+	Subsystem->RegisterGraph(this);
+}
+
+void ATriggerLogicGraph::EndPlay(const EEndPlayReason::Type EndPlayReason) {
+
+	UWorld* World = GetWorld();
+
+	UTriggerLogicSubsystem* Subsystem = World != nullptr ? World->GetSubsystem<UTriggerLogicSubsystem>() : nullptr;
+
+	if (Subsystem != nullptr) {
+
+		Subsystem->UnregisterGraph(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
@@ -0,0 +1,75 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "TriggerLogicGraph.generated.h"
+
+UENUM()
+enum class ETriggerLogicOp : uint8 {
+
+	/** Follows the active state of a trigger. */
+	Trigger,
+
+	/** On while all inputs are on. */
+	And,
+
+	/** On while any input is on. */
+	Or,
+
+	/** On while its input is off. */
+	Not,
+
+	/** Takes its input's state once the input has held it for Delay seconds. */
+	Delay
+};
+
+USTRUCT()
+struct FTriggerLogicNode {
+
+	GENERATED_BODY()
+
+	/** Referenced by the Inputs of other nodes in the same graph. */
+	UPROPERTY(EditAnywhere, Category = "Logic")
+	FName Name;
+
+	UPROPERTY(EditAnywhere, Category = "Logic")
+	ETriggerLogicOp Op = ETriggerLogicOp::Trigger;
+
+	UPROPERTY(EditAnywhere, Category = "Logic", Meta = (EditCondition = "Op == ETriggerLogicOp::Trigger"))
+	class ATriggerPlatform* Trigger = nullptr;
+
+	UPROPERTY(EditAnywhere, Category = "Logic", Meta = (EditCondition = "Op != ETriggerLogicOp::Trigger"))
+	TArray<FName> Inputs;
+
+	UPROPERTY(EditAnywhere, Category = "Logic", Meta = (ClampMin = 0, EditCondition = "Op == ETriggerLogicOp::Delay"))
+	float Delay = 1.f;
+
+	/** Platforms kept moving while this node is on. */
+	UPROPERTY(EditAnywhere, Category = "Logic")
+	TArray<class AMovingPlatform*> PlatformsToTrigger;
+};
+
+/**
+ * Designer-authored AND/OR/NOT/delay logic between triggers and platforms. The graph is plain data: on the server
+ * it is compiled into UTriggerLogicSubsystem at BeginPlay, and the actor itself never ticks or replicates.
+ */
+UCLASS()
+class PUZZLEPLATFORMS_API ATriggerLogicGraph : public AActor
+{
+	GENERATED_BODY()
+
+public:
+
+	ATriggerLogicGraph();
+
+	UPROPERTY(EditAnywhere, Category = "Logic")
+	TArray<FTriggerLogicNode> Nodes;
+
+protected:
+
+	virtual void BeginPlay() override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+};
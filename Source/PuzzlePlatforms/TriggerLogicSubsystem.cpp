@@ -0,0 +1,458 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TriggerLogicSubsystem.h"
+#include "PuzzlePlatforms.h"
+#include "TriggerPlatform.h"
+#include "MovingPlatform.h"
+#include "TimerManager.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+DECLARE_CYCLE_STAT(TEXT("Trigger Logic Evaluation"), STAT_TriggerLogicEvaluation, STATGROUP_PuzzlePlatforms);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Trigger Logic Nodes"), STAT_TriggerLogicNodes, STATGROUP_PuzzlePlatforms);
+
+bool UTriggerLogicSubsystem::ShouldCreateSubsystem(UObject* Outer) const {
+
+	UWorld* World = Cast<UWorld>(Outer);
+
+	return World != nullptr && World->IsGameWorld();
+}
+
+void UTriggerLogicSubsystem::Deinitialize() {
+
+	Graphs.Empty();
+
+	Reset();
+
+	Super::Deinitialize();
+}
+
+void UTriggerLogicSubsystem::RegisterGraph(ATriggerLogicGraph* Graph) {
+
+	if (!ensure(Graph != nullptr) || Graphs.Contains(Graph)) return;
+
+	if (!CompileGraph(Graph)) return;
+
+	Graphs.Add(Graph);
+
+	EvaluateDirty();
+}
+
+void UTriggerLogicSubsystem::UnregisterGraph(ATriggerLogicGraph* Graph) {
+
+	if (Graphs.Remove(Graph) == 0) return;
+
+	// Release every platform the graphs hold; the remaining graphs take theirs back when they are recompiled.
+	for (int32 Node = 0; Node < Ops.Num(); Node++) {
+
+		if (Values[Node]) {
+
+			SetValue(Node, false);
+		}
+	}
+
+	// Graphs only go away with their level, so rebuilding the rest is simpler than compacting the arrays.
+	const TArray<ATriggerLogicGraph*> Remaining = MoveTemp(Graphs);
+
+	Graphs.Reset();
+
+	Reset();
+
+	for (ATriggerLogicGraph* Other : Remaining) {
+
+		if (IsValid(Other)) {
+
+			RegisterGraph(Other);
+		}
+	}
+}
+
+void UTriggerLogicSubsystem::OnTriggerChanged(ATriggerPlatform* Trigger, bool bActive) {
+
+	const TArray<int32>* Nodes = TriggerNodes.Find(Trigger);
+
+	if (Nodes == nullptr) return;
+
+	for (const int32 Node : *Nodes) {
+
+		PendingValues[Node] = bActive;
+
+		MarkDirty(Node);
+	}
+
+	EvaluateDirty();
+}
+
+bool UTriggerLogicSubsystem::CompileGraph(ATriggerLogicGraph* Graph) {
+
+	const TArray<FTriggerLogicNode>& Nodes = Graph->Nodes;
+
+	const int32 NumNodes = Nodes.Num();
+
+	TMap<FName, int32> NodesByName;
+
+	for (int32 i = 0; i < NumNodes; i++) {
+
+		if (Nodes[i].Name.IsNone() || NodesByName.Contains(Nodes[i].Name)) {
+
+			UE_LOG(LogTemp, Warning, TEXT("Trigger logic %s: node %d needs a unique name, graph skipped."), *Graph->GetName(), i);
+			return false;
+		}
+
+		NodesByName.Add(Nodes[i].Name, i);
+	}
+
+	TArray<TArray<int32>> LocalInputs;
+
+	TArray<TArray<int32>> LocalDependents;
+
+	LocalInputs.SetNum(NumNodes);
+
+	LocalDependents.SetNum(NumNodes);
+
+	for (int32 i = 0; i < NumNodes; i++) {
+
+		const FTriggerLogicNode& Node = Nodes[i];
+
+		const bool bTrigger = Node.Op == ETriggerLogicOp::Trigger;
+
+		const bool bSingleInput = Node.Op == ETriggerLogicOp::Not || Node.Op == ETriggerLogicOp::Delay;
+
+		if ((bTrigger && (Node.Trigger == nullptr || Node.Inputs.Num() > 0)) || (!bTrigger && Node.Inputs.Num() == 0) || (bSingleInput && Node.Inputs.Num() != 1)) {
+
+			UE_LOG(LogTemp, Warning, TEXT("Trigger logic %s: node %s has the wrong inputs for its op, graph skipped."), *Graph->GetName(), *Node.Name.ToString());
+			return false;
+		}
+
+		for (const FName& InputName : Node.Inputs) {
+
+			const int32* Input = NodesByName.Find(InputName);
+
+			if (Input == nullptr) {
+
+				UE_LOG(LogTemp, Warning, TEXT("Trigger logic %s: node %s reads unknown node %s, graph skipped."), *Graph->GetName(), *Node.Name.ToString(), *InputName.ToString());
+				return false;
+			}
+
+			LocalInputs[i].Add(*Input);
+
+			LocalDependents[*Input].AddUnique(i);
+		}
+	}
+
+	// Kahn's algorithm: a node is placed once all of its inputs are.
+	TArray<int32> Order;
+
+	TArray<int32> UnplacedInputs;
+
+	Order.Reserve(NumNodes);
+
+	UnplacedInputs.SetNum(NumNodes);
+
+	for (int32 i = 0; i < NumNodes; i++) {
+
+		UnplacedInputs[i] = LocalInputs[i].Num();
+
+		if (UnplacedInputs[i] == 0) {
+
+			Order.Add(i);
+		}
+	}
+
+	for (int32 Placed = 0; Placed < Order.Num(); Placed++) {
+
+		for (const int32 Dependent : LocalDependents[Order[Placed]]) {
+
+			// An input listed twice counts twice.
+			for (const int32 Input : LocalInputs[Dependent]) {
+
+				if (Input == Order[Placed] && --UnplacedInputs[Dependent] == 0) {
+
+					Order.Add(Dependent);
+				}
+			}
+		}
+	}
+
+	if (Order.Num() != NumNodes) {
+
+		UE_LOG(LogTemp, Warning, TEXT("Trigger logic %s: the graph has a cycle, graph skipped."), *Graph->GetName());
+		return false;
+	}
+
+	const int32 Base = Ops.Num();
+
+	TArray<int32> GlobalIndices;
+
+	GlobalIndices.SetNum(NumNodes);
+
+	for (int32 Position = 0; Position < NumNodes; Position++) {
+
+		GlobalIndices[Order[Position]] = Base + Position;
+	}
+
+	for (const int32 Local : Order) {
+
+		const FTriggerLogicNode& Node = Nodes[Local];
+
+		const int32 Global = GlobalIndices[Local];
+
+		Ops.Add(Node.Op);
+		Values.Add(false);
+		PendingValues.Add(false);
+		Delays.Add(FMath::Max(Node.Delay, 0.f));
+		Deadlines.Add(0.f);
+		IsDirty.Add(false);
+
+		FirstInputs.Add(InputNodes.Num());
+		NumInputs.Add(LocalInputs[Local].Num());
+
+		for (const int32 Input : LocalInputs[Local]) {
+
+			InputNodes.Add(GlobalIndices[Input]);
+		}
+
+		FirstDependents.Add(DependentNodes.Num());
+		NumDependents.Add(LocalDependents[Local].Num());
+
+		for (const int32 Dependent : LocalDependents[Local]) {
+
+			DependentNodes.Add(GlobalIndices[Dependent]);
+		}
+
+		FirstPlatforms.Add(OutputPlatforms.Num());
+
+		for (AMovingPlatform* Platform : Node.PlatformsToTrigger) {
+
+			if (Platform != nullptr) {
+
+				OutputPlatforms.Add(Platform);
+			}
+		}
+
+		NumPlatforms.Add(OutputPlatforms.Num() - FirstPlatforms.Last());
+
+		if (Node.Op == ETriggerLogicOp::Trigger) {
+
+			TriggerNodes.FindOrAdd(Node.Trigger).Add(Global);
+
+			PendingValues[Global] = Node.Trigger->IsActive();
+		}
+
+		MarkDirty(Global);
+	}
+
+	INC_DWORD_STAT_BY(STAT_TriggerLogicNodes, NumNodes);
+
+	return true;
+}
+
+void UTriggerLogicSubsystem::Reset() {
+
+	DEC_DWORD_STAT_BY(STAT_TriggerLogicNodes, Ops.Num());
+
+	UWorld* World = GetWorld();
+
+	if (World != nullptr) {
+
+		World->GetTimerManager().ClearTimer(DelayTimer);
+	}
+
+	Ops.Reset();
+	Values.Reset();
+	PendingValues.Reset();
+	Delays.Reset();
+	Deadlines.Reset();
+	FirstInputs.Reset();
+	NumInputs.Reset();
+	InputNodes.Reset();
+	FirstDependents.Reset();
+	NumDependents.Reset();
+	DependentNodes.Reset();
+	FirstPlatforms.Reset();
+	NumPlatforms.Reset();
+	OutputPlatforms.Reset();
+	TriggerNodes.Reset();
+	IsDirty.Reset();
+	DirtyNodes.Reset();
+	PendingDelays.Reset();
+}
+
+void UTriggerLogicSubsystem::MarkDirty(int32 Node) {
+
+	if (IsDirty[Node]) return;
+
+	IsDirty[Node] = true;
+
+	DirtyNodes.HeapPush(Node);
+}
+
+void UTriggerLogicSubsystem::EvaluateDirty() {
+
+	if (DirtyNodes.Num() == 0) return;
+
+	SCOPE_CYCLE_COUNTER(STAT_TriggerLogicEvaluation);
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(UTriggerLogicSubsystem::EvaluateDirty);
+
+	const float Now = GetWorld()->GetTimeSeconds();
+
+	// Dependents always sit after their inputs, so popping the lowest index evaluates each node once, after its inputs.
+	while (DirtyNodes.Num() > 0) {
+
+		int32 Node;
+
+		DirtyNodes.HeapPop(Node, false);
+
+		IsDirty[Node] = false;
+
+		const bool bValue = EvaluateNode(Node, Now);
+
+		if (bValue != Values[Node]) {
+
+			SetValue(Node, bValue);
+		}
+	}
+
+	ScheduleDelayTimer(Now);
+}
+
+bool UTriggerLogicSubsystem::EvaluateNode(int32 Node, float Now) {
+
+	const int32* Inputs = InputNodes.GetData() + FirstInputs[Node];
+
+	switch (Ops[Node]) {
+
+	case ETriggerLogicOp::Trigger:
+		return PendingValues[Node];
+
+	case ETriggerLogicOp::And:
+		for (int32 i = 0; i < NumInputs[Node]; i++) {
+
+			if (!Values[Inputs[i]]) return false;
+		}
+		return true;
+
+	case ETriggerLogicOp::Or:
+		for (int32 i = 0; i < NumInputs[Node]; i++) {
+
+			if (Values[Inputs[i]]) return true;
+		}
+		return false;
+
+	case ETriggerLogicOp::Not:
+		return !Values[Inputs[0]];
+
+	case ETriggerLogicOp::Delay: {
+
+		const bool bInput = Values[Inputs[0]];
+
+		if (bInput == Values[Node]) {
+
+			// The input went back before the delay ran out.
+			if (Deadlines[Node] > 0.f) {
+
+				Deadlines[Node] = 0.f;
+
+				PendingDelays.RemoveSingleSwap(Node, false);
+			}
+		}
+		else if (Delays[Node] <= 0.f) {
+
+			return bInput;
+		}
+		else if (Deadlines[Node] <= 0.f) {
+
+			Deadlines[Node] = Now + Delays[Node];
+
+			PendingValues[Node] = bInput;
+
+			PendingDelays.Add(Node);
+		}
+
+		return Values[Node];
+	}
+
+	default:
+		return Values[Node];
+	}
+}
+
+void UTriggerLogicSubsystem::SetValue(int32 Node, bool bValue) {
+
+	Values[Node] = bValue;
+
+	const int32 LastPlatform = FirstPlatforms[Node] + NumPlatforms[Node];
+
+	for (int32 i = FirstPlatforms[Node]; i < LastPlatform; i++) {
+
+		AMovingPlatform* Platform = OutputPlatforms[i];
+
+		if (!IsValid(Platform)) continue;
+
+		if (bValue) {
+
+			Platform->AddActiveTrigger();
+		}
+		else {
+
+			Platform->RemoveActiveTrigger();
+		}
+	}
+
+	const int32 LastDependent = FirstDependents[Node] + NumDependents[Node];
+
+	for (int32 i = FirstDependents[Node]; i < LastDependent; i++) {
+
+		MarkDirty(DependentNodes[i]);
+	}
+}
+
+void UTriggerLogicSubsystem::OnDelayTimer() {
+
+	const float Now = GetWorld()->GetTimeSeconds();
+
+	for (int32 i = PendingDelays.Num() - 1; i >= 0; i--) {
+
+		const int32 Node = PendingDelays[i];
+
+		if (Deadlines[Node] > Now) continue;
+
+		Deadlines[Node] = 0.f;
+
+		PendingDelays.RemoveAtSwap(i, 1, false);
+
+		if (PendingValues[Node] != Values[Node]) {
+
+			SetValue(Node, PendingValues[Node]);
+		}
+	}
+
+	EvaluateDirty();
+
+	ScheduleDelayTimer(Now);
+}
+
+void UTriggerLogicSubsystem::ScheduleDelayTimer(float Now) {
+
+	FTimerManager& TimerManager = GetWorld()->GetTimerManager();
+
+	if (PendingDelays.Num() == 0) {
+
+		if (DelayTimer.IsValid()) {
+
+			TimerManager.ClearTimer(DelayTimer);
+		}
+
+		return;
+	}
+
+	float NextDeadline = Deadlines[PendingDelays[0]];
+
+	for (const int32 Node : PendingDelays) {
+
+		NextDeadline = FMath::Min(NextDeadline, Deadlines[Node]);
+	}
+
+	TimerManager.SetTimer(DelayTimer, this, &UTriggerLogicSubsystem::OnDelayTimer, FMath::Max(NextDeadline - Now, KINDA_SMALL_NUMBER));
+}
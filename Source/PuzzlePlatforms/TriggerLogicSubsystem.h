@@ -0,0 +1,100 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "TriggerLogicGraph.h"
+#include "TriggerLogicSubsystem.generated.h"
+
+/**
+ * Runs every ATriggerLogicGraph of a server world as one flat, topologically sorted node array.
+ * Each graph is appended when it registers, so a node's inputs always sit at lower indices. A trigger change
+ * marks its nodes dirty, and only dirty nodes are re-evaluated, lowest index first, which visits every node after
+ * all of its inputs. Delay nodes share a single world timer set for the earliest pending deadline.
+ */
+UCLASS()
+class PUZZLEPLATFORMS_API UTriggerLogicSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+
+	virtual void Deinitialize() override;
+
+	void RegisterGraph(ATriggerLogicGraph* Graph);
+
+	void UnregisterGraph(ATriggerLogicGraph* Graph);
+
+	/** Called by triggers on the server when their active state flips. */
+	void OnTriggerChanged(class ATriggerPlatform* Trigger, bool bActive);
+
+	int32 GetNumNodes() const { return Ops.Num(); }
+
+private:
+
+	UPROPERTY()
+	TArray<ATriggerLogicGraph*> Graphs;
+
+	TArray<ETriggerLogicOp> Ops;
+
+	TArray<bool> Values;
+
+	/** State of the trigger behind Trigger nodes; the value a Delay node will take when its deadline passes. */
+	TArray<bool> PendingValues;
+
+	TArray<float> Delays;
+
+	/** World time a Delay node takes its pending value at, or 0 when none is pending. */
+	TArray<float> Deadlines;
+
+	TArray<int32> FirstInputs;
+
+	TArray<int32> NumInputs;
+
+	TArray<int32> InputNodes;
+
+	TArray<int32> FirstDependents;
+
+	TArray<int32> NumDependents;
+
+	TArray<int32> DependentNodes;
+
+	TArray<int32> FirstPlatforms;
+
+	TArray<int32> NumPlatforms;
+
+	UPROPERTY()
+	TArray<class AMovingPlatform*> OutputPlatforms;
+
+	TMap<TObjectKey<class ATriggerPlatform>, TArray<int32>> TriggerNodes;
+
+	TArray<bool> IsDirty;
+
+	/** Min-heap of dirty node indices. */
+	TArray<int32> DirtyNodes;
+
+	/** Delay nodes with a pending deadline. */
+	TArray<int32> PendingDelays;
+
+	FTimerHandle DelayTimer;
+
+	bool CompileGraph(ATriggerLogicGraph* Graph);
+
+	void Reset();
+
+	void MarkDirty(int32 Node);
+
+	void EvaluateDirty();
+
+	bool EvaluateNode(int32 Node, float Now);
+
+	void SetValue(int32 Node, bool bValue);
+
+	void OnDelayTimer();
+
+	void ScheduleDelayTimer(float Now);
+};
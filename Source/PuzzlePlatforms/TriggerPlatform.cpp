@@ -5,12 +5,27 @@
 #include "Components/BoxComponent.h"
 #include "Components/StaticMeshComponent.h"
 #include "MovingPlatform.h"
+#include "TriggerSubsystem.h"
+#include "TriggerLogicSubsystem.h"
+#include "PuzzlePlatforms.h"
+#include "GameFramework/Pawn.h"
+#include "Net/UnrealNetwork.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+DECLARE_CYCLE_STAT(TEXT("Trigger Overlap Begin"), STAT_TriggerOverlapBegin, STATGROUP_PuzzlePlatforms);
+DECLARE_CYCLE_STAT(TEXT("Trigger Overlap End"), STAT_TriggerOverlapEnd, STATGROUP_PuzzlePlatforms);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Active Triggers"), STAT_ActiveTriggers, STATGROUP_PuzzlePlatforms);
 
 // Sets default values
 ATriggerPlatform::ATriggerPlatform()
 {
- 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+ 	// Triggers are purely overlap driven and never need to tick.
+	PrimaryActorTick.bCanEverTick = false;
+
+	// Only bActive replicates, and only when it flips.
+	bReplicates = true;
+
+	NetDormancy = DORM_DormantAll;
 
 	BoxComponent = CreateDefaultSubobject<UBoxComponent>(TEXT("BoxComponent"));
 
@@ -32,29 +47,161 @@ ATriggerPlatform::ATriggerPlatform()
 void ATriggerPlatform::BeginPlay()
 {
 	Super::BeginPlay();
-	
+
+	// Clients take bActive from the server, so they never need to evaluate overlaps.
+	if (!HasAuthority()) {
+
+		BoxComponent->SetGenerateOverlapEvents(false);
+
+		return;
+	}
+
+	UTriggerSubsystem* Subsystem = GetTriggerSubsystem();
+
+	if (Subsystem != nullptr && Subsystem->IsSpatialHashEnabled()) {
+
+		BoxComponent->SetGenerateOverlapEvents(false);
+
+		Subsystem->RegisterTrigger(this);
+	}
 }
 
-// Called every frame
-void ATriggerPlatform::Tick(float DeltaTime)
-{
-	Super::Tick(DeltaTime);
+void ATriggerPlatform::EndPlay(const EEndPlayReason::Type EndPlayReason) {
+
+	UTriggerSubsystem* Subsystem = GetTriggerSubsystem();
+
+	if (Subsystem != nullptr) {
+
+		Subsystem->UnregisterTrigger(this);
+	}
 
+	Super::EndPlay(EndPlayReason);
+
+	if (bActive && HasAuthority()) {
+
+		DEC_DWORD_STAT(STAT_ActiveTriggers);
+	}
+
+	Occupants.Empty();
 }
 
-void ATriggerPlatform::OnOverlapBegin(class UPrimitiveComponent* OverlappedComp, class AActor* OtherActor, class UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult) {
-	
+void ATriggerPlatform::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const {
+
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(ATriggerPlatform, bActive);
+}
+
+void ATriggerPlatform::AddPlatformToTrigger(AMovingPlatform* Platform) {
+
+	PlatformsToTrigger.Add(Platform);
+}
+
+void ATriggerPlatform::ActivatePlatforms() {
+
 	for (AMovingPlatform* Platform : PlatformsToTrigger) {
 
 		Platform->AddActiveTrigger();
 	}
 }
 
-void ATriggerPlatform::OnOverlapEnd(class UPrimitiveComponent* OverlappedComp, class AActor* OtherActor, class UPrimitiveComponent* OtherComp, int32 OtherBodyIndex) {
-	
+void ATriggerPlatform::DeactivatePlatforms() {
+
 	for (AMovingPlatform* Platform : PlatformsToTrigger) {
 
 		Platform->RemoveActiveTrigger();
 	}
 }
 
+void ATriggerPlatform::OnOverlapBegin(class UPrimitiveComponent* OverlappedComp, class AActor* OtherActor, class UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult) {
+
+	SCOPE_CYCLE_COUNTER(STAT_TriggerOverlapBegin);
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(ATriggerPlatform::OnOverlapBegin);
+
+	APawn* Pawn = Cast<APawn>(OtherActor);
+
+	if (Pawn == nullptr || !HasAuthority()) return;
+
+	BeginOccupancy(Pawn);
+}
+
+void ATriggerPlatform::OnOverlapEnd(class UPrimitiveComponent* OverlappedComp, class AActor* OtherActor, class UPrimitiveComponent* OtherComp, int32 OtherBodyIndex) {
+
+	SCOPE_CYCLE_COUNTER(STAT_TriggerOverlapEnd);
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(ATriggerPlatform::OnOverlapEnd);
+
+	APawn* Pawn = Cast<APawn>(OtherActor);
+
+	if (Pawn == nullptr || !HasAuthority()) return;
+
+	// Another component of the same pawn may still be on the trigger.
+	if (BoxComponent->IsOverlappingActor(Pawn)) return;
+
+	EndOccupancy(Pawn);
+}
+
+void ATriggerPlatform::BeginOccupancy(const TObjectKey<APawn>& Pawn) {
+
+	bool bAlreadyInside = false;
+
+	Occupants.Add(Pawn, &bAlreadyInside);
+
+	if (!bAlreadyInside && Occupants.Num() == 1) {
+
+		SetActive(true);
+	}
+}
+
+void ATriggerPlatform::EndOccupancy(const TObjectKey<APawn>& Pawn) {
+
+	if (Occupants.Remove(Pawn) > 0 && Occupants.Num() == 0) {
+
+		SetActive(false);
+	}
+}
+
+void ATriggerPlatform::SetActive(bool bNewActive) {
+
+	if (bActive == bNewActive) return;
+
+	bActive = bNewActive;
+
+	if (bActive) {
+
+		INC_DWORD_STAT(STAT_ActiveTriggers);
+
+		ActivatePlatforms();
+	}
+	else {
+
+		DEC_DWORD_STAT(STAT_ActiveTriggers);
+
+		DeactivatePlatforms();
+	}
+
+	FlushNetDormancy();
+
+	UTriggerLogicSubsystem* LogicSubsystem = GetWorld()->GetSubsystem<UTriggerLogicSubsystem>();
+
+	if (LogicSubsystem != nullptr) {
+
+		LogicSubsystem->OnTriggerChanged(this, bActive);
+	}
+
+	ReceiveActiveChanged(bActive);
+}
+
+void ATriggerPlatform::OnRep_Active() {
+
+	ReceiveActiveChanged(bActive);
+}
+
+UTriggerSubsystem* ATriggerPlatform::GetTriggerSubsystem() const {
+
+	UWorld* World = GetWorld();
+
+	return World != nullptr ? World->GetSubsystem<UTriggerSubsystem>() : nullptr;
+}
+
@@ -4,8 +4,14 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "UObject/ObjectKey.h"
 #include "TriggerPlatform.generated.h"
 
+/**
+ * Pressure plate that keeps its PlatformsToTrigger moving while at least one pawn stands on it.
+ * Occupancy is only evaluated on the server; clients receive the resulting bActive.
+ * A trigger can also be an input of an ATriggerLogicGraph, with PlatformsToTrigger left empty.
+ */
 UCLASS()
 class PUZZLEPLATFORMS_API ATriggerPlatform : public AActor
 {
@@ -21,18 +27,56 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Collision")
 	class UStaticMeshComponent* Mesh;
 
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	bool IsActive() const { return bActive; }
+
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 private:
 
 	UPROPERTY(EditAnywhere, Category = "Platforms" )
 	TArray<class AMovingPlatform*> PlatformsToTrigger;
 
+	/** Whether any pawn is on the trigger. */
+	UPROPERTY(ReplicatedUsing = OnRep_Active)
+	bool bActive = false;
+
+	/** Pawns on the trigger, each counted once however many of its components overlap. Server only. */
+	TSet<TObjectKey<class APawn>> Occupants;
+
+	UFUNCTION()
+	void OnRep_Active();
+
+	void SetActive(bool bNewActive);
+
+	friend class UTriggerSubsystem;
+
+	/** Id in the UTriggerSubsystem spatial hash, or INDEX_NONE when overlap events drive the trigger. */
+	int32 HashId = INDEX_NONE;
+
+	class UTriggerSubsystem* GetTriggerSubsystem() const;
+
 public:	
-	// Called every frame
-	virtual void Tick(float DeltaTime) override;
+
+	void AddPlatformToTrigger(class AMovingPlatform* Platform);
+
+	void ActivatePlatforms();
+
+	void DeactivatePlatforms();
+
+	/** A pawn stepped on or off the trigger. Only the first arrival and the last departure reach the platforms. */
+	void BeginOccupancy(const TObjectKey<class APawn>& Pawn);
+
+	void EndOccupancy(const TObjectKey<class APawn>& Pawn);
+
+	/** Blueprint hook for visuals, called on the server and on clients when bActive changes. */
+	UFUNCTION(BlueprintImplementableEvent, Category = "Triggers")
+	void ReceiveActiveChanged(bool bNewActive);
 
 	UFUNCTION()
 	void OnOverlapBegin(class UPrimitiveComponent* OverlappedComp, class AActor* OtherActor, class UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
@@ -0,0 +1,128 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TriggerSpatialHash.h"
+
+FTriggerSpatialHash::FTriggerSpatialHash(float InCellSize) {
+
+	CellSize = FMath::Max(InCellSize, 1.f);
+
+	InvCellSize = 1.f / CellSize;
+}
+
+int32 FTriggerSpatialHash::Add(const FBox& Volume) {
+
+	int32 Id;
+
+	if (FreeIds.Num() > 0) {
+
+		Id = FreeIds.Pop(false);
+
+		Volumes[Id] = Volume;
+	}
+	else {
+
+		Id = Volumes.Add(Volume);
+	}
+
+	const FIntVector Min = ToCell(Volume.Min);
+
+	const FIntVector Max = ToCell(Volume.Max);
+
+	for (int32 X = Min.X; X <= Max.X; X++) {
+
+		for (int32 Y = Min.Y; Y <= Max.Y; Y++) {
+
+			for (int32 Z = Min.Z; Z <= Max.Z; Z++) {
+
+				Cells.FindOrAdd(FIntVector(X, Y, Z)).Add(Id);
+			}
+		}
+	}
+
+	return Id;
+}
+
+void FTriggerSpatialHash::Remove(int32 Id) {
+
+	if (!ensure(Volumes.IsValidIndex(Id) && Volumes[Id].IsValid)) return;
+
+	const FIntVector Min = ToCell(Volumes[Id].Min);
+
+	const FIntVector Max = ToCell(Volumes[Id].Max);
+
+	for (int32 X = Min.X; X <= Max.X; X++) {
+
+		for (int32 Y = Min.Y; Y <= Max.Y; Y++) {
+
+			for (int32 Z = Min.Z; Z <= Max.Z; Z++) {
+
+				const FIntVector Cell(X, Y, Z);
+
+				TArray<int32>* Ids = Cells.Find(Cell);
+
+				if (Ids == nullptr) continue;
+
+				Ids->RemoveSingleSwap(Id, false);
+
+				if (Ids->Num() == 0) {
+
+					Cells.Remove(Cell);
+				}
+			}
+		}
+	}
+
+	Volumes[Id].Init();
+
+	FreeIds.Add(Id);
+}
+
+void FTriggerSpatialHash::Reset() {
+
+	Volumes.Reset();
+
+	FreeIds.Reset();
+
+	Cells.Reset();
+}
+
+void FTriggerSpatialHash::Query(const FBox& Box, TArray<int32>& OutIds) const {
+
+	const FIntVector Min = ToCell(Box.Min);
+
+	const FIntVector Max = ToCell(Box.Max);
+
+	const int32 FirstResult = OutIds.Num();
+
+	for (int32 X = Min.X; X <= Max.X; X++) {
+
+		for (int32 Y = Min.Y; Y <= Max.Y; Y++) {
+
+			for (int32 Z = Min.Z; Z <= Max.Z; Z++) {
+
+				const TArray<int32>* Ids = Cells.Find(FIntVector(X, Y, Z));
+
+				if (Ids == nullptr) continue;
+
+				for (const int32 Id : *Ids) {
+
+					if (!Volumes[Id].Intersect(Box)) continue;
+
+					// A volume spanning several of the visited cells is listed in each of them.
+					bool bAlreadyFound = false;
+
+					for (int32 i = FirstResult; i < OutIds.Num() && !bAlreadyFound; i++) {
+
+						bAlreadyFound = OutIds[i] == Id;
+					}
+
+					if (!bAlreadyFound) {
+
+						OutIds.Add(Id);
+					}
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,72 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Uniform grid of axis-aligned trigger volumes, hashed by cell coordinates so only occupied cells use memory.
+ * A volume is listed in every cell it overlaps; a query only visits the cells its own box overlaps.
+ */
+struct PUZZLEPLATFORMS_API FTriggerSpatialHash {
+
+	explicit FTriggerSpatialHash(float InCellSize = 1000.f);
+
+	/** Returns the id of the new volume. Ids of removed volumes are reused. */
+	int32 Add(const FBox& Volume);
+
+	void Remove(int32 Id);
+
+	void Reset();
+
+	int32 Num() const { return Volumes.Num() - FreeIds.Num(); }
+
+	int32 GetNumCells() const { return Cells.Num(); }
+
+	/** Appends the ids of every volume intersecting Box to OutIds, each once. */
+	void Query(const FBox& Box, TArray<int32>& OutIds) const;
+
+	/** Calls OnLeft for each id only in Previous and OnEntered for each id only in Current, in one pass over both sorted lists. */
+	template <typename LeftFunc, typename EnteredFunc>
+	static void DiffSorted(const TArray<int32>& Previous, const TArray<int32>& Current, LeftFunc&& OnLeft, EnteredFunc&& OnEntered) {
+
+		int32 i = 0;
+
+		int32 j = 0;
+
+		while (i < Previous.Num() || j < Current.Num()) {
+
+			if (j == Current.Num() || (i < Previous.Num() && Previous[i] < Current[j])) {
+
+				OnLeft(Previous[i++]);
+			}
+			else if (i == Previous.Num() || Current[j] < Previous[i]) {
+
+				OnEntered(Current[j++]);
+			}
+			else {
+
+				i++;
+
+				j++;
+			}
+		}
+	}
+
+private:
+
+	float CellSize;
+
+	float InvCellSize;
+
+	TArray<FBox> Volumes;
+
+	TArray<int32> FreeIds;
+
+	TMap<FIntVector, TArray<int32>> Cells;
+
+	FIntVector ToCell(const FVector& Location) const {
+
+		return FIntVector(FMath::FloorToInt(Location.X * InvCellSize), FMath::FloorToInt(Location.Y * InvCellSize), FMath::FloorToInt(Location.Z * InvCellSize));
+	}
+};
@@ -0,0 +1,186 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TriggerSubsystem.h"
+#include "PuzzlePlatforms.h"
+#include "TriggerPlatform.h"
+#include "Components/BoxComponent.h"
+#include "GameFramework/Pawn.h"
+#include "EngineUtils.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+DECLARE_CYCLE_STAT(TEXT("Trigger Spatial Hash Evaluation"), STAT_TriggerHashEvaluation, STATGROUP_PuzzlePlatforms);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Hashed Triggers"), STAT_HashedTriggers, STATGROUP_PuzzlePlatforms);
+
+bool UTriggerSubsystem::ShouldCreateSubsystem(UObject* Outer) const {
+
+	UWorld* World = Cast<UWorld>(Outer);
+
+	return World != nullptr && World->IsGameWorld();
+}
+
+void UTriggerSubsystem::Initialize(FSubsystemCollectionBase& Collection) {
+
+	Super::Initialize(Collection);
+
+	Hash = FTriggerSpatialHash(CellSize);
+
+	UWorld* World = GetWorld();
+
+	if (!bUseSpatialHash || !ensure(World != nullptr && World->PersistentLevel != nullptr)) return;
+
+	TickFunction.Subsystem = this;
+	TickFunction.TickGroup = TG_PostPhysics;
+	TickFunction.bCanEverTick = true;
+
+	// Enabled while at least one trigger is registered.
+	TickFunction.SetTickFunctionEnable(false);
+
+	TickFunction.RegisterTickFunction(World->PersistentLevel);
+}
+
+void UTriggerSubsystem::Deinitialize() {
+
+	if (TickFunction.IsTickFunctionRegistered()) {
+
+		TickFunction.UnRegisterTickFunction();
+	}
+
+	TickFunction.Subsystem = nullptr;
+
+	DEC_DWORD_STAT_BY(STAT_HashedTriggers, Hash.Num());
+
+	for (ATriggerPlatform* Trigger : Triggers) {
+
+		if (Trigger != nullptr) {
+
+			Trigger->HashId = INDEX_NONE;
+		}
+	}
+
+	Triggers.Empty();
+
+	PawnTriggers.Empty();
+
+	Hash.Reset();
+
+	Super::Deinitialize();
+}
+
+void UTriggerSubsystem::RegisterTrigger(ATriggerPlatform* Trigger) {
+
+	if (!ensure(Trigger != nullptr && Trigger->BoxComponent != nullptr)) return;
+
+	if (!ensure(Trigger->HashId == INDEX_NONE)) return;
+
+	Trigger->HashId = Hash.Add(Trigger->BoxComponent->Bounds.GetBox());
+
+	if (Trigger->HashId >= Triggers.Num()) {
+
+		Triggers.SetNum(Trigger->HashId + 1);
+	}
+
+	Triggers[Trigger->HashId] = Trigger;
+
+	INC_DWORD_STAT(STAT_HashedTriggers);
+
+	TickFunction.SetTickFunctionEnable(true);
+}
+
+void UTriggerSubsystem::UnregisterTrigger(ATriggerPlatform* Trigger) {
+
+	if (Trigger == nullptr || !Triggers.IsValidIndex(Trigger->HashId)) return;
+
+	const int32 Id = Trigger->HashId;
+
+	if (!ensure(Triggers[Id] == Trigger)) return;
+
+	// Like a trigger destroyed with actors on it, report everyone still inside as leaving.
+	for (TPair<TObjectKey<APawn>, TArray<int32>>& Pair : PawnTriggers) {
+
+		if (Pair.Value.RemoveSingle(Id) > 0) {
+
+			Trigger->EndOccupancy(Pair.Key);
+		}
+	}
+
+	Hash.Remove(Id);
+
+	Triggers[Id] = nullptr;
+
+	Trigger->HashId = INDEX_NONE;
+
+	DEC_DWORD_STAT(STAT_HashedTriggers);
+
+	if (Hash.Num() == 0) {
+
+		TickFunction.SetTickFunctionEnable(false);
+	}
+}
+
+void UTriggerSubsystem::Tick(float DeltaTime) {
+
+	SCOPE_CYCLE_COUNTER(STAT_TriggerHashEvaluation);
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(UTriggerSubsystem::Tick);
+
+	for (TActorIterator<APawn> It(GetWorld()); It; ++It) {
+
+		APawn* Pawn = *It;
+
+		const USceneComponent* Root = Pawn->GetRootComponent();
+
+		if (Root == nullptr) continue;
+
+		QueryResults.Reset();
+
+		Hash.Query(Root->Bounds.GetBox(), QueryResults);
+
+		QueryResults.Sort();
+
+		const TObjectKey<APawn> PawnKey(Pawn);
+
+		TArray<int32>& Previous = PawnTriggers.FindOrAdd(PawnKey);
+
+		// Both lists are sorted, so one merge pass finds the triggers entered and left since last frame.
+		FTriggerSpatialHash::DiffSorted(Previous, QueryResults,
+			[this, &PawnKey](int32 Id) { Triggers[Id]->EndOccupancy(PawnKey); },
+			[this, &PawnKey](int32 Id) { Triggers[Id]->BeginOccupancy(PawnKey); });
+
+		Previous = QueryResults;
+	}
+
+	for (auto It = PawnTriggers.CreateIterator(); It; ++It) {
+
+		if (It->Key.ResolveObjectPtr() == nullptr) {
+
+			ExitAll(It->Value, It->Key);
+
+			It.RemoveCurrent();
+		}
+	}
+}
+
+void UTriggerSubsystem::ExitAll(const TArray<int32>& Ids, const TObjectKey<APawn>& Pawn) {
+
+	for (const int32 Id : Ids) {
+
+		if (Triggers[Id] != nullptr) {
+
+			Triggers[Id]->EndOccupancy(Pawn);
+		}
+	}
+}
+
+void FTriggerTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) {
+
+	if (Subsystem != nullptr && TickType != LEVELTICK_ViewportsOnly) {
+
+		Subsystem->Tick(DeltaTime);
+	}
+}
+
+FString FTriggerTickFunction::DiagnosticMessage() {
+
+	return TEXT("UTriggerSubsystem::Tick");
+}
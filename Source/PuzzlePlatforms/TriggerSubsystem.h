@@ -0,0 +1,77 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Engine/EngineBaseTypes.h"
+#include "UObject/ObjectKey.h"
+#include "TriggerSpatialHash.h"
+#include "TriggerSubsystem.generated.h"
+
+/** Runs UTriggerSubsystem::Tick after physics, once pawns have moved for the frame. */
+struct FTriggerTickFunction : public FTickFunction {
+
+	class UTriggerSubsystem* Subsystem = nullptr;
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+
+	virtual FString DiagnosticMessage() override;
+};
+
+/**
+ * Optional replacement for the overlap events of ATriggerPlatform on maps with very many triggers.
+ * With bUseSpatialHash set, triggers turn their box overlap events off and register their bounds here instead;
+ * each frame the server tests the bounds of every pawn against the triggers in the cells around it and
+ * reports pawns entering and leaving a trigger the same way the overlap events would.
+ * Only pawns are tested, and trigger bounds are taken once, axis-aligned, when the trigger begins play.
+ */
+UCLASS(Config = Game)
+class PUZZLEPLATFORMS_API UTriggerSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	virtual void Deinitialize() override;
+
+	bool IsSpatialHashEnabled() const { return bUseSpatialHash; }
+
+	void RegisterTrigger(class ATriggerPlatform* Trigger);
+
+	void UnregisterTrigger(class ATriggerPlatform* Trigger);
+
+	int32 GetNumTriggers() const { return Hash.Num(); }
+
+	float GetCellSize() const { return CellSize; }
+
+	void Tick(float DeltaTime);
+
+private:
+
+	UPROPERTY(Config)
+	bool bUseSpatialHash = false;
+
+	/** Edge length of a hash cell; a few times the size of a typical trigger works best. */
+	UPROPERTY(Config)
+	float CellSize = 1000.f;
+
+	FTriggerSpatialHash Hash;
+
+	/** Trigger of each hash id, null for free ids. */
+	UPROPERTY()
+	TArray<class ATriggerPlatform*> Triggers;
+
+	/** Hash ids each pawn was inside of last frame, sorted. */
+	TMap<TObjectKey<class APawn>, TArray<int32>> PawnTriggers;
+
+	TArray<int32> QueryResults;
+
+	FTriggerTickFunction TickFunction;
+
+	void ExitAll(const TArray<int32>& Ids, const TObjectKey<class APawn>& Pawn);
+};
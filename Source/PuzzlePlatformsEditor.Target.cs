@@ -9,6 +9,6 @@ public class PuzzlePlatformsEditorTarget : TargetRules
 	{
 		Type = TargetType.Editor;
 		DefaultBuildSettings = BuildSettingsVersion.V2;
-		ExtraModuleNames.Add("PuzzlePlatforms");
+		ExtraModuleNames.AddRange(new string[] { "PuzzlePlatforms", "PuzzlePlatformsMenu" });
 	}
 }
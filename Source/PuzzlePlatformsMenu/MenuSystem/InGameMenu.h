@@ -10,7 +10,7 @@
  * 
  */
 UCLASS()
-class PUZZLEPLATFORMS_API UInGameMenu : public UMenuWidget
+class PUZZLEPLATFORMSMENU_API UInGameMenu : public UMenuWidget
 {
 	GENERATED_BODY()
 
@@ -0,0 +1,328 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MainMenu.h"
+#include "Components/Button.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
+#include "Components/WidgetSwitcher.h"
+#include "ServerRow.h"
+#include "Components/EditableTextBox.h"
+#include "Components/TextBlock.h"
+#include "PuzzlePlatforms.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+DECLARE_CYCLE_STAT(TEXT("Main Menu Set Server List"), STAT_MainMenuSetServerList, STATGROUP_PuzzlePlatforms);
+DECLARE_CYCLE_STAT(TEXT("Main Menu Refresh Rows"), STAT_MainMenuRefreshServerRows, STATGROUP_PuzzlePlatforms);
+
+
+UMainMenu::UMainMenu(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer) {
+
+	ServerRowClass = TSoftClassPtr<UServerRow>(FSoftObjectPath(TEXT("/Game/MenuSystem/ServerRow_WBP.ServerRow_WBP_C")));
+
+}
+
+bool UMainMenu::Initialize() {
+
+	bool Success = Super::Initialize();
+
+	if (!Success) return false;
+
+	//TODO: SETUP
+
+	if (!ensure(HostButton != nullptr)) return false;
+
+	HostButton->OnClicked.AddDynamic(this, &UMainMenu::OpenHostMenu);
+
+	if (!ensure(JoinButton != nullptr)) return false;
+
+	JoinButton->OnClicked.AddDynamic(this, &UMainMenu::OpenJoinMenu);
+
+	if (!ensure(QuitButton != nullptr)) return false;
+
+	QuitButton->OnClicked.AddDynamic(this, &UMainMenu::QuitGame);
+
+	if (!ensure(CancelHostButton != nullptr)) return false;
+
+	CancelHostButton->OnClicked.AddDynamic(this, &UMainMenu::OpenMainMenu);
+
+	if (!ensure(HostGameButton != nullptr)) return false;
+
+	HostGameButton->OnClicked.AddDynamic(this, &UMainMenu::HostServer);
+
+	if (!ensure(CancelJoinButton != nullptr)) return false;
+
+	CancelJoinButton->OnClicked.AddDynamic(this, &UMainMenu::OpenMainMenu);
+
+	if (!ensure(JoinIPButton != nullptr)) return false;
+
+	JoinIPButton->OnClicked.AddDynamic(this, &UMainMenu::JoinServer);
+
+	if (RefreshButton != nullptr) {
+
+		RefreshButton->OnClicked.AddDynamic(this, &UMainMenu::RestartServerSearch);
+	}
+
+	// Rows are only needed once the join menu has results, so their class streams in meanwhile.
+	if (!IsDesignTime() && ServerRowClass.Get() == nullptr && !ServerRowClass.IsNull()) {
+
+		ServerRowClassHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(ServerRowClass.ToSoftObjectPath(), FStreamableDelegate::CreateUObject(this, &UMainMenu::RefreshServerRows));
+	}
+
+	return true;
+}
+
+void UMainMenu::OpenHostMenu() {
+
+	MenuSwitcher->SetActiveWidget(HostMenu);
+
+}
+
+
+void UMainMenu::HostServer() {
+
+	if (MenuInterface != nullptr) {
+
+		FString ServerName = ServerHostName->Text.ToString();
+
+		MenuInterface->Host(ServerName);
+	}
+}
+
+void UMainMenu::SetServerList(const TArray<FServerData>& InServerDataList) {
+
+	SCOPE_CYCLE_COUNTER(STAT_MainMenuSetServerList);
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(UMainMenu::SetServerList);
+
+	ServerDataList = InServerDataList;
+
+	RefreshServerRows();
+}
+
+void UMainMenu::SetServerSort(EServerSortMode InSortMode, int32 InMaxPing, bool bInHideFull) {
+
+	SortMode = InSortMode;
+
+	MaxPing = InMaxPing;
+
+	bHideFull = bInHideFull;
+
+	RefreshServerRows();
+}
+
+bool UMainMenu::IsServerVisible(const FServerData& ServerData) const {
+
+	if (bHideFull && ServerData.IsFull()) return false;
+
+	if (MaxPing > 0 && ServerData.PingMs != INDEX_NONE && ServerData.PingMs > MaxPing) return false;
+
+	return true;
+}
+
+void UMainMenu::RefreshServerRows() {
+
+	SCOPE_CYCLE_COUNTER(STAT_MainMenuRefreshServerRows);
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(UMainMenu::RefreshServerRows);
+
+	UWorld* World = this->GetWorld();
+
+	if (!ensure(World != nullptr)) return;
+
+	// The list is kept and shown once the row class has finished loading.
+	if (ServerRowClass.Get() == nullptr) return;
+
+	TArray<int32> Order;
+
+	Order.Reserve(ServerDataList.Num());
+
+	for (int32 i = 0; i < ServerDataList.Num(); i++) {
+
+		if (IsServerVisible(ServerDataList[i])) {
+
+			Order.Add(i);
+		}
+	}
+
+	if (SortMode == EServerSortMode::Ping) {
+
+		Order.StableSort([this](int32 A, int32 B) {
+
+			const uint32 PingA = uint32(ServerDataList[A].PingMs);
+			const uint32 PingB = uint32(ServerDataList[B].PingMs);
+
+			// INDEX_NONE wraps to the largest value, so unmeasured hosts sort last.
+			return PingA < PingB;
+		});
+	}
+	else if (SortMode == EServerSortMode::Fill) {
+
+		Order.StableSort([this](int32 A, int32 B) {
+
+			const FServerData& DataA = ServerDataList[A];
+			const FServerData& DataB = ServerDataList[B];
+
+			if (DataA.IsFull() != DataB.IsFull()) return DataB.IsFull();
+
+			return DataA.CurrentPlayers > DataB.CurrentPlayers;
+		});
+	}
+
+	TSet<FString> ListedSessions;
+
+	ListedSessions.Reserve(Order.Num());
+
+	TArray<UServerRow*> OrderedRows;
+
+	OrderedRows.Reserve(Order.Num());
+
+	for (const int32 i : Order) {
+
+		const FServerData& ServerData = ServerDataList[i];
+
+		ListedSessions.Add(ServerData.SessionId);
+
+		UServerRow* Row = RowsBySessionId.FindRef(ServerData.SessionId);
+
+		if (Row == nullptr) {
+
+			Row = AcquireRow();
+
+			if (!ensure(Row != nullptr)) return;
+
+			RowsBySessionId.Add(ServerData.SessionId, Row);
+		}
+
+		Row->SetServerData(ServerData, i);
+
+		OrderedRows.Add(Row);
+	}
+
+	for (auto It = RowsBySessionId.CreateIterator(); It; ++It) {
+
+		if (!ListedSessions.Contains(It.Key())) {
+
+			ReleaseRow(It.Value());
+
+			It.RemoveCurrent();
+		}
+	}
+
+	// Only re-slot the (already existing) rows when the visible order actually changed.
+	bool bOrderChanged = ServerList->GetChildrenCount() != OrderedRows.Num();
+
+	for (int32 i = 0; !bOrderChanged && i < OrderedRows.Num(); i++) {
+
+		bOrderChanged = ServerList->GetChildAt(i) != OrderedRows[i];
+	}
+
+	if (bOrderChanged) {
+
+		ServerList->ClearChildren();
+
+		for (UServerRow* Row : OrderedRows) {
+
+			ServerList->AddChild(Row);
+		}
+	}
+}
+
+UServerRow* UMainMenu::AcquireRow() {
+
+	if (RowPool.Num() > 0) {
+
+		return RowPool.Pop(false);
+	}
+
+	UServerRow* Row = CreateWidget<UServerRow>(this, ServerRowClass.Get());
+
+	if (Row != nullptr) {
+
+		Row->Setup(this);
+	}
+
+	return Row;
+}
+
+void UMainMenu::ReleaseRow(UServerRow* Row) {
+
+	if (Row == SelectedRow) {
+
+		SelectRow(nullptr);
+	}
+
+	Row->RemoveFromParent();
+
+	RowPool.Add(Row);
+}
+
+void UMainMenu::SelectRow(UServerRow* Row) {
+
+	if (SelectedRow != nullptr) {
+
+		SelectedRow->bSelected = false;
+	}
+
+	SelectedRow = Row;
+
+	if (SelectedRow != nullptr) {
+
+		SelectedRow->bSelected = true;
+	}
+}
+
+void UMainMenu::JoinServer() {
+
+	if (SelectedRow != nullptr && MenuInterface != nullptr) {
+
+		UE_LOG(LogTemp, Warning, TEXT("Selected Index: %d"), SelectedRow->Index);
+		MenuInterface->Join(SelectedRow->Index);
+	}
+	else {
+
+		UE_LOG(LogTemp, Warning, TEXT("Selected Index Not Set"));
+	}
+}
+
+void UMainMenu::QuitGame() {
+
+	UWorld* World = GetWorld();
+
+	if (!ensure(World != nullptr)) return;
+
+	APlayerController* PlayerController = World->GetFirstPlayerController();
+
+	PlayerController->ConsoleCommand("quit");
+}
+
+void UMainMenu::OpenJoinMenu() {
+
+	if (!ensure(MenuSwitcher != nullptr)) return;
+
+	if (!ensure(JoinMenu != nullptr)) return;
+
+	MenuSwitcher->SetActiveWidget(JoinMenu);
+
+	if (MenuInterface != nullptr) {
+
+		MenuInterface->RefreshingServerList();
+	}
+}
+
+void UMainMenu::OpenMainMenu() {
+
+	if (!ensure(MenuSwitcher != nullptr)) return;
+
+	if (!ensure(this != nullptr)) return;
+
+	MenuSwitcher->SetActiveWidget(this);
+}
+
+void UMainMenu::RestartServerSearch() {
+
+	if (MenuInterface != nullptr) {
+
+		MenuInterface->RefreshingServerList(true);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,132 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MenuWidget.h"
+#include "MenuSystem/ServerData.h"
+#include "MainMenu.generated.h"
+
+/**
+ * 
+ */
+UCLASS()
+class PUZZLEPLATFORMSMENU_API UMainMenu : public UMenuWidget {	
+	
+	GENERATED_BODY()	
+
+public:
+
+	UMainMenu(const FObjectInitializer& ObjectInitializer);
+
+	/** Adds, updates and removes rows by session id. Rows are recycled instead of rebuilt. */
+	void SetServerList(const TArray<FServerData>& InServerDataList);
+
+	/** Orders the visible rows and hides hosts slower than InMaxPing (0 for no limit) or full ones. */
+	UFUNCTION(BlueprintCallable)
+	void SetServerSort(EServerSortMode InSortMode, int32 InMaxPing, bool bInHideFull);
+
+	void SelectRow(class UServerRow* Row);
+
+	const TSoftClassPtr<class UServerRow>& GetServerRowClass() const { return ServerRowClass; }
+
+protected:
+
+	virtual bool Initialize() override;
+
+private:
+
+	UPROPERTY(meta = (BindWidget))
+	class UButton* HostButton;
+
+	UPROPERTY(meta = (BindWidget))
+	class UButton* JoinButton;
+
+	UPROPERTY(meta = (BindWidget))
+	class UButton* QuitButton;
+
+	UPROPERTY(meta = (BindWidget))
+	class UButton* JoinIPButton;
+
+	UPROPERTY(meta = (BindWidget))
+	class UButton* CancelJoinButton;
+
+	UPROPERTY(meta = (BindWidget))
+	class UWidgetSwitcher* MenuSwitcher;
+
+	UPROPERTY(meta = (BindWidget))
+	class UWidget* JoinMenu;
+
+	UPROPERTY(meta = (BindWidget))
+	class UWidget* HostMenu;
+
+	UPROPERTY(meta = (BindWidget))
+	class UEditableTextBox* ServerHostName;
+
+	UPROPERTY(meta = (BindWidget))
+	class UButton* CancelHostButton;
+
+	UPROPERTY(meta = (BindWidget))
+	class UButton* HostGameButton;
+
+	UPROPERTY(meta = (BindWidget))
+	class UPanelWidget* ServerList;
+
+	UPROPERTY(meta = (BindWidgetOptional))
+	class UButton* RefreshButton;
+
+	UPROPERTY(EditDefaultsOnly)
+	TSoftClassPtr<class UServerRow> ServerRowClass;
+
+	/** Keeps ServerRowClass loaded while the menu is open. */
+	TSharedPtr<struct FStreamableHandle> ServerRowClassHandle;
+
+	/** Latest list from the menu interface; row indices refer to it. */
+	TArray<FServerData> ServerDataList;
+
+	EServerSortMode SortMode = EServerSortMode::Discovery;
+
+	int32 MaxPing = 0;
+
+	bool bHideFull = false;
+
+	UPROPERTY()
+	TMap<FString, class UServerRow*> RowsBySessionId;
+
+	/** Rows removed from the list, kept for reuse. */
+	UPROPERTY()
+	TArray<class UServerRow*> RowPool;
+
+	UPROPERTY()
+	class UServerRow* SelectedRow;
+
+	UFUNCTION()
+	void HostServer();
+
+	UFUNCTION()
+	void JoinServer();
+
+	UFUNCTION()
+	void QuitGame();
+
+	UFUNCTION()
+	void OpenHostMenu();
+
+	UFUNCTION()
+	void OpenJoinMenu();
+
+	UFUNCTION()
+	void OpenMainMenu();
+
+	UFUNCTION()
+	void RestartServerSearch();
+
+	void RefreshServerRows();
+
+	bool IsServerVisible(const FServerData& ServerData) const;
+
+	class UServerRow* AcquireRow();
+
+	void ReleaseRow(class UServerRow* Row);
+	
+};
@@ -4,14 +4,14 @@
 
 #include "CoreMinimal.h"
 #include "Blueprint/UserWidget.h"
-#include "MainMenuInterface.h"
+#include "MenuSystem/MainMenuInterface.h"
 #include "MenuWidget.generated.h"
 
 /**
  * 
  */
 UCLASS()
-class PUZZLEPLATFORMS_API UMenuWidget : public UUserWidget
+class PUZZLEPLATFORMSMENU_API UMenuWidget : public UUserWidget
 {
 	GENERATED_BODY()
 	
@@ -0,0 +1,52 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ServerRow.h"
+#include "Components/Button.h"
+#include "Components/TextBlock.h"
+#include "MainMenu.h"
+
+bool UServerRow::Initialize() {
+
+	bool Success = Super::Initialize();
+
+	if (!Success) return false;
+
+	if (!ensure(RowButton != nullptr)) return false;
+
+	RowButton->OnClicked.AddDynamic(this, &UServerRow::OnClicked);
+
+	return true;
+}
+
+void UServerRow::Setup(class UMainMenu* InParent) {
+
+	Parent = InParent;
+}
+
+void UServerRow::SetServerData(const FServerData& InServerData, uint32 InIndex) {
+
+	Index = InIndex;
+
+	if (ServerData.IsSet() && ServerData.GetValue() == InServerData) return;
+
+	ServerName->SetText(FText::FromString(InServerData.Name));
+
+	HostUser->SetText(FText::FromString(InServerData.HostUserName));
+
+	FString FractionText = FString::Printf(TEXT("%d / %d"), InServerData.CurrentPlayers, InServerData.TotalPlayers);
+
+	ConnectionFraction->SetText(FText::FromString(FractionText));
+
+	if (Ping != nullptr) {
+
+		Ping->SetText(InServerData.PingMs != INDEX_NONE ? FText::FromString(FString::Printf(TEXT("%d ms"), InServerData.PingMs)) : FText::FromString(TEXT("-")));
+	}
+
+	ServerData = InServerData;
+}
+
+void UServerRow::OnClicked() {
+
+	Parent->SelectRow(this);
+}
\ No newline at end of file
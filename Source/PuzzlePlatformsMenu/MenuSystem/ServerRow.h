@@ -4,13 +4,14 @@
 
 #include "CoreMinimal.h"
 #include "Blueprint/UserWidget.h"
+#include "MenuSystem/ServerData.h"
 #include "ServerRow.generated.h"
 
 /**
  * 
  */
 UCLASS()
-class PUZZLEPLATFORMS_API UServerRow : public UUserWidget
+class PUZZLEPLATFORMSMENU_API UServerRow : public UUserWidget
 {
 	GENERATED_BODY()
 
@@ -25,6 +26,9 @@ public:
 	UPROPERTY(meta = (BindWidget))
 	class UTextBlock* ConnectionFraction;
 
+	UPROPERTY(meta = (BindWidgetOptional))
+	class UTextBlock* Ping;
+
 	UPROPERTY(meta = (BindWidget))
 	class UButton* RowButton;
 
@@ -36,8 +40,19 @@ public:
 
 	uint32 Index;
 
-	void Setup(class UMainMenu* InParent, uint32 InIndex);
+	void Setup(class UMainMenu* InParent);
+
+	/** Refreshes the row's texts, skipping them when the data hasn't changed. */
+	void SetServerData(const FServerData& InServerData, uint32 InIndex);
 
 	UFUNCTION()
 	void OnClicked();
+
+protected:
+
+	virtual bool Initialize() override;
+
+private:
+
+	TOptional<FServerData> ServerData;
 };
@@ -0,0 +1,209 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "PuzzlePlatformsMenuSubsystem.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
+#include "PuzzlePlatformsGameInstance.h"
+#include "MenuSystem/MainMenu.h"
+#include "MenuSystem/MenuWidget.h"
+
+UPuzzlePlatformsMenuSubsystem::UPuzzlePlatformsMenuSubsystem() {
+
+	MenuClass = TSoftClassPtr<UMainMenu>(FSoftObjectPath(TEXT("/Game/MenuSystem/MainMenu_WBP.MainMenu_WBP_C")));
+
+	InGameMenuClass = TSoftClassPtr<UMenuWidget>(FSoftObjectPath(TEXT("/Game/MenuSystem/InGameMenu_WBP.InGameMenu_WBP_C")));
+}
+
+bool UPuzzlePlatformsMenuSubsystem::ShouldCreateSubsystem(UObject* Outer) const {
+
+	// Dedicated servers have no one to show a menu to.
+	return !IsRunningDedicatedServer() && Cast<UPuzzlePlatformsGameInstance>(Outer) != nullptr;
+}
+
+void UPuzzlePlatformsMenuSubsystem::Initialize(FSubsystemCollectionBase& Collection) {
+
+	Super::Initialize(Collection);
+
+	auto GameInstance = Cast<UPuzzlePlatformsGameInstance>(GetGameInstance());
+
+	if (!ensure(GameInstance != nullptr)) return;
+
+	GameInstance->OnLoadMenu.AddUObject(this, &UPuzzlePlatformsMenuSubsystem::LoadMenu);
+
+	GameInstance->OnLoadPauseMenu.AddUObject(this, &UPuzzlePlatformsMenuSubsystem::LoadPauseMenu);
+
+	GameInstance->OnPreloadMenus.AddUObject(this, &UPuzzlePlatformsMenuSubsystem::PreloadMenus);
+
+	GameInstance->OnTearDownMenu.AddUObject(this, &UPuzzlePlatformsMenuSubsystem::TearDownMenu);
+
+	GameInstance->OnServerListChanged.AddUObject(this, &UPuzzlePlatformsMenuSubsystem::SetServerList);
+
+	GameInstance->OnServerSortChanged.AddUObject(this, &UPuzzlePlatformsMenuSubsystem::SetServerSort);
+
+	FCoreUObjectDelegates::PreLoadMap.AddUObject(this, &UPuzzlePlatformsMenuSubsystem::OnPreLoadMap);
+
+	FCoreUObjectDelegates::PostLoadMapWithWorld.AddUObject(this, &UPuzzlePlatformsMenuSubsystem::OnPostLoadMap);
+}
+
+void UPuzzlePlatformsMenuSubsystem::Deinitialize() {
+
+	auto GameInstance = Cast<UPuzzlePlatformsGameInstance>(GetGameInstance());
+
+	if (GameInstance != nullptr) {
+
+		GameInstance->OnLoadMenu.RemoveAll(this);
+
+		GameInstance->OnLoadPauseMenu.RemoveAll(this);
+
+		GameInstance->OnPreloadMenus.RemoveAll(this);
+
+		GameInstance->OnTearDownMenu.RemoveAll(this);
+
+		GameInstance->OnServerListChanged.RemoveAll(this);
+
+		GameInstance->OnServerSortChanged.RemoveAll(this);
+	}
+
+	FCoreUObjectDelegates::PreLoadMap.RemoveAll(this);
+
+	FCoreUObjectDelegates::PostLoadMapWithWorld.RemoveAll(this);
+
+	Super::Deinitialize();
+}
+
+void UPuzzlePlatformsMenuSubsystem::LoadMenu() {
+
+	LoadMenuClass(MenuClass.ToSoftObjectPath(), FSimpleDelegate::CreateUObject(this, &UPuzzlePlatformsMenuSubsystem::CreateMainMenu));
+}
+
+void UPuzzlePlatformsMenuSubsystem::CreateMainMenu() {
+
+	UClass* LoadedMenuClass = MenuClass.Get();
+
+	if (!ensure(LoadedMenuClass != nullptr)) return;
+
+	auto GameInstance = Cast<UPuzzlePlatformsGameInstance>(GetGameInstance());
+
+	if (!ensure(GameInstance != nullptr)) return;
+
+	Menu = CreateWidget<UMainMenu>(GameInstance, LoadedMenuClass);
+
+	if (!ensure(Menu != nullptr)) return;
+
+	Menu->Setup();
+
+	Menu->SetMainMenuInterface(GameInstance);
+}
+
+void UPuzzlePlatformsMenuSubsystem::LoadPauseMenu() {
+
+	LoadMenuClass(InGameMenuClass.ToSoftObjectPath(), FSimpleDelegate::CreateUObject(this, &UPuzzlePlatformsMenuSubsystem::CreatePauseMenu));
+}
+
+void UPuzzlePlatformsMenuSubsystem::CreatePauseMenu() {
+
+	if (InGameMenu == nullptr) {
+
+		UClass* LoadedInGameMenuClass = InGameMenuClass.Get();
+
+		if (!ensure(LoadedInGameMenuClass != nullptr)) return;
+
+		auto GameInstance = Cast<UPuzzlePlatformsGameInstance>(GetGameInstance());
+
+		if (!ensure(GameInstance != nullptr)) return;
+
+		InGameMenu = CreateWidget<UMenuWidget>(GameInstance, LoadedInGameMenuClass);
+
+		if (!ensure(InGameMenu != nullptr)) return;
+
+		InGameMenu->SetMainMenuInterface(GameInstance);
+	}
+
+	if (!InGameMenu->IsInViewport()) {
+
+		InGameMenu->Setup();
+	}
+}
+
+void UPuzzlePlatformsMenuSubsystem::PreloadMenus() {
+
+	LoadMenuClass(MenuClass.ToSoftObjectPath(), FSimpleDelegate::CreateWeakLambda(this, [this]() {
+
+		// The server row class hangs off the main menu, so it can only be resolved once that is loaded.
+		const UMainMenu* DefaultMenu = MenuClass.IsValid() ? MenuClass->GetDefaultObject<UMainMenu>() : nullptr;
+
+		if (DefaultMenu != nullptr) {
+
+			LoadMenuClass(DefaultMenu->GetServerRowClass().ToSoftObjectPath(), FSimpleDelegate());
+		}
+	}));
+
+	LoadMenuClass(InGameMenuClass.ToSoftObjectPath(), FSimpleDelegate());
+}
+
+void UPuzzlePlatformsMenuSubsystem::TearDownMenu() {
+
+	if (Menu != nullptr) {
+
+		Menu->TearDown();
+	}
+}
+
+void UPuzzlePlatformsMenuSubsystem::LoadMenuClass(const FSoftObjectPath& ClassPath, FSimpleDelegate OnLoaded) {
+
+	if (ClassPath.IsNull()) return;
+
+	if (ClassPath.ResolveObject() != nullptr) {
+
+		OnLoaded.ExecuteIfBound();
+
+		return;
+	}
+
+	const double LoadStartTime = FPlatformTime::Seconds();
+
+	TSharedPtr<FStreamableHandle> Handle = UAssetManager::GetStreamableManager().RequestAsyncLoad(ClassPath, FStreamableDelegate::CreateWeakLambda(this, [ClassPath, LoadStartTime, OnLoaded]() {
+
+		UE_LOG(LogTemp, Warning, TEXT("Loaded %s in %.1fms."), *ClassPath.GetAssetName(), (FPlatformTime::Seconds() - LoadStartTime) * 1000.0);
+
+		OnLoaded.ExecuteIfBound();
+	}));
+
+	if (Handle.IsValid()) {
+
+		MenuLoadHandles.Add(Handle);
+	}
+}
+
+void UPuzzlePlatformsMenuSubsystem::SetServerList(const TArray<FServerData>& ServerDataList) {
+
+	if (Menu != nullptr) {
+
+		Menu->SetServerList(ServerDataList);
+	}
+}
+
+void UPuzzlePlatformsMenuSubsystem::SetServerSort(EServerSortMode SortMode, int32 MaxPing, bool bHideFull) {
+
+	if (Menu != nullptr) {
+
+		Menu->SetServerSort(SortMode, MaxPing, bHideFull);
+	}
+}
+
+void UPuzzlePlatformsMenuSubsystem::OnPreLoadMap(const FString& MapName) {
+
+	// Menus belong to the map they were opened in. Cleared before the load, since the new map's BeginPlay can create its menu before PostLoadMap.
+	Menu = nullptr;
+
+	InGameMenu = nullptr;
+}
+
+void UPuzzlePlatformsMenuSubsystem::OnPostLoadMap(UWorld* LoadedWorld) {
+
+	if (bPreloadMenusAtMainMenu && LoadedWorld != nullptr && UWorld::RemovePIEPrefix(LoadedWorld->GetMapName()) == TEXT("MainMenu")) {
+
+		PreloadMenus();
+	}
+}
@@ -0,0 +1,74 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "MenuSystem/ServerData.h"
+#include "PuzzlePlatformsMenuSubsystem.generated.h"
+
+/**
+ * Owns the menu widgets for UPuzzlePlatformsGameInstance. The game instance only raises delegates, so the
+ * gameplay module builds without UMG and server targets leave this module out entirely.
+ */
+UCLASS(Config = Game)
+class PUZZLEPLATFORMSMENU_API UPuzzlePlatformsMenuSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	UPuzzlePlatformsMenuSubsystem();
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	virtual void Deinitialize() override;
+
+	void LoadMenu();
+
+	void LoadPauseMenu();
+
+	/** Starts loading the menu widget classes so the first LoadMenu or LoadPauseMenu does not wait on them. */
+	void PreloadMenus();
+
+	void TearDownMenu();
+
+private:
+
+	/** Menu widgets are soft references so startup never loads UMG assets it does not show. */
+	UPROPERTY(Config)
+	TSoftClassPtr<class UMainMenu> MenuClass;
+
+	UPROPERTY(Config)
+	TSoftClassPtr<class UMenuWidget> InGameMenuClass;
+
+	/** Preload the menu classes when the main menu map loads. */
+	UPROPERTY(Config)
+	bool bPreloadMenusAtMainMenu = true;
+
+	/** Keep the loaded menu classes in memory. */
+	TArray<TSharedPtr<struct FStreamableHandle>> MenuLoadHandles;
+
+	UPROPERTY()
+	class UMainMenu* Menu;
+
+	/** Reused by LoadPauseMenu for as long as the current map is loaded. */
+	UPROPERTY()
+	class UMenuWidget* InGameMenu;
+
+	void LoadMenuClass(const FSoftObjectPath& ClassPath, FSimpleDelegate OnLoaded);
+
+	void CreateMainMenu();
+
+	void CreatePauseMenu();
+
+	void SetServerList(const TArray<FServerData>& ServerDataList);
+
+	void SetServerSort(EServerSortMode SortMode, int32 MaxPing, bool bHideFull);
+
+	void OnPreLoadMap(const FString& MapName);
+
+	void OnPostLoadMap(UWorld* LoadedWorld);
+};